@@ -36,9 +36,15 @@ enum class hypercall_id
     HC_SC_CTRL = 10,
     HC_PT_CTRL = 11,
     HC_SM_CTRL = 12,
+    HC_DELEGATE_BATCH = 14,
     HC_MACHINE_CTRL = 15,
     HC_CREATE_KP = 16,
     HC_KP_CTRL = 17,
     HC_CREATE_VCPU = 19,
     HC_VCPU_CTRL = 20,
+    HC_SM_WAIT_ANY = 21,
+    HC_CREATE_NOTIFICATION = 22,
+    HC_NOTIFICATION_CTRL = 23,
+    HC_MULTICALL = 24,
+    HC_CREATE_BULK = 25,
 };
@@ -23,6 +23,7 @@
 #include "alloc_result.hpp"
 #include "extern.hpp"
 #include "memory.hpp"
+#include "page_cache_stats.hpp"
 #include "spinlock.hpp"
 
 class Buddy
@@ -59,6 +60,25 @@ private:
 
     inline mword index_to_page(signed long i) { return base + i * PAGE_SIZE; }
 
+    // Allocate a block. The caller must hold the lock. Returns zero, if there is no free block.
+    mword alloc_locked(unsigned short ord);
+
+    // Allocate a block. If this fails, give the pages from the local page cache back and try again.
+    mword alloc_or_drain(unsigned short ord);
+
+    // Free a block. The caller must hold the lock.
+    void free_locked(mword virt);
+
+    // Allocate up to n single pages while acquiring the lock only once. Returns the number of pages.
+    size_t alloc_batch(mword* pages, size_t n);
+
+    // Free single pages while acquiring the lock only once.
+    void free_batch(mword const* pages, size_t n);
+
+    // Single pages are allocated from and freed to per-CPU caches, once CPU-local memory is available. See
+    // Per_cpu::buddy_page_cache.
+    static bool use_page_cache();
+
     inline mword virt_to_phys(mword virt) { return VIRT_TO_PHYS_NORELOC(virt) + PHYS_RELOCATION; }
 
     inline mword phys_to_virt(mword phys) { return PHYS_TO_VIRT_NORELOC(phys - PHYS_RELOCATION); }
@@ -97,6 +117,20 @@ public:
 
     void free(mword addr);
 
+    // Free a chain of blocks while acquiring the lock only once.
+    //
+    // The first word of each block holds the address of the next block in the chain. The chain is terminated
+    // by zero.
+    void free_chain(mword addr);
+
+    // Zero a free page ahead of time, so a later allocation with FILL_0 does not have to.
+    //
+    // This is meant to be called when the CPU is idle. Returns false, if there is nothing to do.
+    bool prezero_page();
+
+    // Return the counters of the page caches of the given CPU. See machine_ctrl_page_cache_stats.
+    static Page_cache_stats page_cache_stats(unsigned cpu);
+
     static inline void* phys_to_ptr(Paddr phys)
     {
         return reinterpret_cast<void*>(allocator.phys_to_virt(static_cast<mword>(phys)));
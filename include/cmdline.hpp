@@ -39,9 +39,18 @@ private:
 public:
     static inline bool serial;
     static inline bool nodl;
+    static inline bool noipcfast;
     static inline bool nopcid;
+    static inline bool nosysret;
     static inline bool novga;
     static inline bool novpid;
+    static inline bool nox2apic;
+
+#ifdef BENCHMARKS
+    static inline bool ipcbench;
+    static inline bool ipcremote;
+    static inline bool syscallbench;
+#endif
 
     static void init(char const*);
 };
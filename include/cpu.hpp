@@ -53,6 +53,7 @@ public:
         FEAT_MONITOR = 35,
         FEAT_VMX = 37,
         FEAT_PCID = 49,
+        FEAT_X2APIC = 53,
         FEAT_TSC_DEADLINE = 56,
         FEAT_XSAVE = 58,
         FEAT_FSGSBASE = 96,
@@ -61,6 +62,8 @@ public:
         FEAT_1GB_PAGES = 154,
         FEAT_CMP_LEGACY = 161,
         FEAT_XSAVEOPT = 192,
+        FEAT_XSAVEC = 193,
+        FEAT_XSAVES = 195,
 
         FEAT_IBRS_IBPB = 7 * 32 + 26,
         FEAT_STIBP = 7 * 32 + 27,
@@ -167,6 +170,7 @@ public:
     static unsigned& hazard(unsigned cpu) { return remote_ref_hazard(cpu); }
 
     CPULOCAL_REMOTE_ACCESSOR(cpu, might_lose_nmis);
+    CPULOCAL_REMOTE_ACCESSOR(cpu, kick_pending);
 
     CPULOCAL_ACCESSOR(cpu, features);
     CPULOCAL_ACCESSOR(cpu, bsp);
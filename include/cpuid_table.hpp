@@ -0,0 +1,80 @@
+/*
+ * CPUID Table for vCPUs
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "memory.hpp"
+#include "types.hpp"
+
+// A single CPUID result as the VMM provides it in the CPUID table page.
+struct Cpuid_entry {
+    enum Flags : uint32
+    {
+        // The entry is in use. The table ends at the first unused entry.
+        VALID = 1U << 0,
+
+        // The entry only matches if ECX equals the subleaf.
+        SUBLEAF = 1U << 1,
+    };
+
+    uint32 leaf, subleaf, flags, reserved;
+    uint32 eax, ebx, ecx, edx;
+};
+static_assert(sizeof(Cpuid_entry) == 32, "CPUID table entry layout is part of the ABI.");
+
+// A page of CPUID results that the VMM fills to let the kernel handle CPUID exits without a round trip to the
+// VMM.
+//
+// The VMM owns the memory and can modify it at any time. Each entry is copied before it is used, so a
+// concurrent modification can at worst result in a mix of old and new values of a single entry.
+class Cpuid_table
+{
+public:
+    static constexpr size_t ENTRIES{PAGE_SIZE / sizeof(Cpuid_entry)};
+
+    explicit Cpuid_table(const void* page) : entries(static_cast<const Cpuid_entry*>(page)) {}
+
+    // Looks up the result of CPUID for the given leaf (EAX) and subleaf (ECX). Returns false if the table has
+    // no matching entry.
+    bool lookup(uint32 leaf, uint32 subleaf, Cpuid_entry& result) const
+    {
+        for (size_t i{0}; i < ENTRIES; i++) {
+            const Cpuid_entry entry{copy(entries[i])};
+
+            if (not(entry.flags & Cpuid_entry::VALID)) {
+                break;
+            }
+
+            if (entry.leaf == leaf and (not(entry.flags & Cpuid_entry::SUBLEAF) or entry.subleaf == subleaf)) {
+                result = entry;
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+private:
+    // Copies an entry field by field, because the VMM may modify the table while we read it.
+    static Cpuid_entry copy(const Cpuid_entry& e)
+    {
+        const volatile Cpuid_entry& v{e};
+        return {v.leaf, v.subleaf, v.flags, 0, v.eax, v.ebx, v.ecx, v.edx};
+    }
+
+    const Cpuid_entry* entries;
+};
@@ -21,8 +21,11 @@
 #include "config.hpp"
 #include "gdt.hpp"
 #include "memory.hpp"
+#include "page_cache.hpp"
 #include "rcu_list.hpp"
+#include "ready_queue.hpp"
 #include "rq.hpp"
+#include "tlb_ranges.hpp"
 #include "types.hpp"
 #include "vmx_types.hpp"
 
@@ -69,6 +72,9 @@ struct alignas(PAGE_SIZE) Per_cpu {
     // A CPU can set this to true to prevent other CPUs from sending NMIs.
     bool cpu_might_lose_nmis;
 
+    // Set when another CPU has sent an NMI to this CPU that has not been received yet. See Lapic::kick.
+    bool cpu_kick_pending;
+
     // The current execution context.
     Ec* ec_current;
 
@@ -86,8 +92,7 @@ struct alignas(PAGE_SIZE) Per_cpu {
 
     // Scheduling-related variables
     Rq sc_rq;
-    Sc* sc_list[NUM_PRIORITIES];
-    unsigned sc_prio_top;
+    Ready_queue<Sc, NUM_PRIORITIES> sc_ready;
     unsigned sc_ctr_link;
     unsigned sc_ctr_loop;
 
@@ -137,6 +142,20 @@ struct alignas(PAGE_SIZE) Per_cpu {
 
     // Space_mem shootdown table.
     uint16 space_mem_tlb_shootdown[NUM_CPU];
+
+    // Host TLB entries that other CPUs asked this CPU to invalidate.
+    Tlb_pending space_mem_tlb_pending;
+
+    // Free single pages that are handed out by the buddy allocator without taking its lock.
+    Page_cache<64> buddy_page_cache;
+
+    // Free single pages that the idle loop has already zeroed. See Buddy::prezero_page.
+    Page_cache<64> buddy_zeroed_page_cache;
+
+    // The unused rest of the page that the magazines of the slab caches are taken from. See
+    // Slab_policy::alloc_magazine.
+    char* slab_magazine_mem;
+    size_t slab_magazine_free;
 };
 
 static_assert(OFFSETOF(Per_cpu, self) == STACK_SIZE,
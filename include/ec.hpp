@@ -28,12 +28,15 @@
 
 #include "cpulocal.hpp"
 #include "fpu.hpp"
+#include "kp.hpp"
 #include "lock_guard.hpp"
 #include "math.hpp"
 #include "mtd.hpp"
 #include "pd.hpp"
+#include "proxy_budget.hpp"
 #include "queue.hpp"
 #include "regs.hpp"
+#include "rq.hpp"
 #include "sc.hpp"
 #include "syscall.hpp"
 #include "tss.hpp"
@@ -46,12 +49,22 @@
 // exception the first time a scheduling context is bound to them.
 #define EXC_STARTUP (NUM_EXC - 2)
 
+class Pt;
 class Sm;
 class Utcb;
+class Ec;
+
+// One of the semaphores an EC waits for in Ec::sys_sm_wait_any.
+struct Sm_waiter {
+    Sm* sm;
+    Ec* ec;
+    Sm_waiter *prev, *next;
+};
 
 class Ec : public Typed_kobject<Kobject::Type::EC>, public Refcount, public Queue<Sc>
 {
     friend class Queue<Ec>;
+    friend class Mpsc_queue<Ec>;
 
     // Needs access to NMI handling functions.
     friend class Vcpu;
@@ -72,6 +85,35 @@ private:
     Ec* partner{nullptr};
     Ec* prev{nullptr};
     Ec* next{nullptr};
+
+    // Callers on other CPUs put themselves into the mailbox of the handler EC. The CPU of the handler moves
+    // them into the queue of pending cross-CPU calls before it starts them. See Ec::sys_call_remote.
+    Mpsc_queue<Ec> mailbox;
+    Queue<Ec> xcalls;
+
+    // The portal of the cross-CPU call this EC is waiting for. While the call is pending, the EC keeps its
+    // continuation and counts as blocked, so it cannot be entered by a call on its own CPU.
+    mword xcall_id{0};
+    mword xcall_ip{0};
+    bool xcall_pending{false};
+
+    // The proxy SCs that run this EC as the handler of cross-CPU calls.
+    static constexpr unsigned MAX_XCALL_PROXIES{4};
+    Proxy_budget<MAX_XCALL_PROXIES> xcall_proxies;
+
+    // The semaphores this EC waits for in Ec::sys_sm_wait_any. The first semaphore that has a resource for
+    // this EC claims the wakeup by setting sm_wait_index.
+    static constexpr unsigned MAX_SM_WAIT_ANY{8};
+    Sm_waiter sm_waiters[MAX_SM_WAIT_ANY];
+    unsigned sm_wait_count{0};
+    unsigned sm_wait_index{0};
+
+    // The progress of the batch of system calls this EC executes in Ec::sys_multicall. The system calls
+    // clobber the argument registers, so the ones that the multicall does not return anything in are saved.
+    Refptr<Kp> multicall_kp;
+    mword multicall_pos{0};
+    mword multicall_count{0};
+    mword multicall_args[3];
     union {
         struct {
             uint16 cpu;
@@ -195,8 +237,15 @@ private:
 
     void transfer_fpu(Ec*);
 
+    // Point the kernel entry stacks for interrupts and system calls at the register state of this EC.
+    void set_entry_stacks();
+
     [[noreturn]] static void idle();
 
+    // Called by Ec::activate when a proxy SC of a cross-CPU call runs this handler EC. Starts the next
+    // pending call or drops the proxy SC, if there is nothing left for it to do.
+    void serve_remote_calls();
+
 public:
     // Capability permission bitmask.
     enum
@@ -226,7 +275,13 @@ public:
 
     ~Ec();
 
-    inline bool blocked() const { return next || !cont; }
+    inline bool blocked() const { return next || !cont || Atomic::load(xcall_pending) || waits_for_any_sm(); }
+
+    // Whether this EC waits in Ec::sys_sm_wait_any and none of its semaphores has claimed the wakeup yet.
+    inline bool waits_for_any_sm() const
+    {
+        return sm_wait_count and Atomic::load(sm_wait_index) == MAX_SM_WAIT_ANY;
+    }
 
     inline void save_fsgs_base()
     {
@@ -265,6 +320,9 @@ public:
             load_fsgs_base();
         }
 
+        // The FPU state is switched eagerly. If the registers kept the state of the previous EC, speculative
+        // execution could leak it to this one (LazyFP, CVE-2018-3665). XSAVES skips components that are
+        // unmodified or in their initial state, which keeps the switch cheap.
         transfer_fpu(current());
 
         if (EXPECT_FALSE(current()->del_rcu()))
@@ -283,6 +341,11 @@ public:
     // This function also resets the kernel stack.
     [[noreturn]] void return_to_user();
 
+    // Return to user via ret_user_sysexit without going through the continuation. This is how the IPC fast
+    // path in Ec::sys_call and Ec::sys_reply enters its partner. The continuation must already be
+    // ret_user_sysexit.
+    [[noreturn]] void return_to_user_sysexit();
+
     // Access the current EC on a remote core.
     //
     // The returned pointer stays valid until the next transition to
@@ -377,8 +440,30 @@ public:
 
     [[noreturn]] HOT static void reply(void (*)() = nullptr, Sm* = nullptr);
 
+    // Reply to the given caller that is waiting in ret_user_sysexit without going through its continuation.
+    // Falls back to Ec::reply if the reply has to schedule.
+    [[noreturn]] HOT static void reply_fast(Ec*);
+
     [[noreturn]] HOT static void sys_call();
 
+    // Call a portal whose handler EC runs on another CPU. The caller is queued in the mailbox of the handler
+    // and blocks until the reply arrives. The handler runs on a proxy SC with the priority of the caller, or
+    // on an existing proxy SC if the handler already has MAX_XCALL_PROXIES of them.
+    [[noreturn]] static void sys_call_remote(Pt*);
+
+    // Start the next pending cross-CPU call in the current EC.
+    [[noreturn]] static void recv_remote();
+
+    // Release the caller of a cross-CPU call to the given continuation and continue the current EC at c.
+    [[noreturn]] static void reply_remote(void (*c)(), void (*)());
+
+    // Wake up this EC, which waits for the reply to a cross-CPU call, at the given continuation.
+    void release_remote(void (*c)())
+    {
+        Atomic::store(xcall_pending, false);
+        release(c);
+    }
+
     [[noreturn]] HOT static void sys_reply();
 
     [[noreturn]] static void sys_create_pd();
@@ -393,6 +478,10 @@ public:
 
     [[noreturn]] static void sys_create_kp();
 
+    [[noreturn]] static void sys_create_notification();
+
+    [[noreturn]] static void sys_create_bulk();
+
     [[noreturn]] static void sys_create_vcpu();
 
     [[noreturn]] static void sys_revoke();
@@ -407,6 +496,8 @@ public:
 
     [[noreturn]] static void sys_pd_ctrl_msr_access();
 
+    [[noreturn]] static void sys_delegate_batch();
+
     [[noreturn]] static void sys_ec_ctrl();
 
     [[noreturn]] static void sys_sc_ctrl();
@@ -415,6 +506,39 @@ public:
 
     [[noreturn]] static void sys_sm_ctrl();
 
+    [[noreturn]] static void sys_sm_wait_any();
+
+    [[noreturn]] static void sys_notification_ctrl();
+
+    [[noreturn]] static void sys_multicall();
+
+    // Start the next system call of the batch of the current EC.
+    [[noreturn]] static void multicall_next();
+
+    // Record the result of the current system call of the batch and continue with the next one.
+    [[noreturn]] static void multicall_continue();
+
+    // Leave the batch and return the number of system calls that succeeded to user space.
+    [[noreturn]] static void multicall_finish();
+
+    // The continuation of an EC that was woken up from Ec::sys_sm_wait_any. Removes the EC from the remaining
+    // semaphores and returns the index of the semaphore that woke it up.
+    [[noreturn]] static void sys_sm_wait_any_done();
+
+    // The continuation of an EC that was woken up from Ec::sys_sm_wait_any, because one of the semaphores was
+    // revoked. Removes the EC from the remaining semaphores and returns BAD_CAP.
+    [[noreturn]] static void sys_sm_wait_any_revoked();
+
+    // Remove the current EC from all semaphores it waited for in Ec::sys_sm_wait_any.
+    static void sm_wait_any_leave();
+
+    // Claim the wakeup of an EC that waits in Ec::sys_sm_wait_any for the semaphore of the given waiter.
+    // Only the first claim succeeds.
+    bool claim_sm_wait_any(Sm_waiter const* w)
+    {
+        return Atomic::cmp_swap(sm_wait_index, MAX_SM_WAIT_ANY, static_cast<unsigned>(w - sm_waiters));
+    }
+
     [[noreturn]] static void sys_kp_ctrl();
 
     [[noreturn]] static void sys_kp_ctrl_map();
@@ -427,14 +551,42 @@ public:
 
     [[noreturn]] static void sys_vcpu_ctrl_poke();
 
+    [[noreturn]] static void sys_vcpu_ctrl_exit_mtd();
+
+    [[noreturn]] static void sys_vcpu_ctrl_load_state();
+
+    [[noreturn]] static void sys_vcpu_ctrl_cpuid_table();
+
+    [[noreturn]] static void sys_vcpu_ctrl_msr_table();
+
+    [[noreturn]] static void sys_vcpu_ctrl_exit_stats();
+
     [[noreturn]] static void sys_machine_ctrl();
 
     [[noreturn]] static void sys_machine_ctrl_suspend();
 
     [[noreturn]] static void sys_machine_ctrl_update_microcode();
 
+    [[noreturn]] static void sys_machine_ctrl_page_cache_stats();
+
     [[noreturn]] static void root_invoke();
 
+#ifdef BENCHMARKS
+    // Instead of starting the roottask, run a loop of invalid hypercalls in user space to measure the
+    // hypercall round trip. See the syscallbench command-line parameter.
+    [[noreturn]] static void root_invoke_syscall_bench();
+
+    // Account for one hypercall of the benchmark started by root_invoke_syscall_bench.
+    static void sample_syscall_bench();
+
+    // Instead of starting the roottask, let the root EC call a second EC in a loop to measure one-way and
+    // round-trip IPC latency. See the ipcbench command-line parameter.
+    [[noreturn]] static void root_invoke_ipc_bench();
+
+    // Account for one call of the benchmark started by root_invoke_ipc_bench.
+    static void sample_ipc_bench();
+#endif
+
     template <bool> static Delegate_result_void delegate();
 
     [[noreturn]] static void dead() { die("IPC Abort"); }
@@ -60,3 +60,8 @@ extern "C" uint32 const __start_cpu_patch_rel_end[];
 // There is a label before the "iretq" in Ec::ret_user_iret. Check Ec::maybe_handle_deferred_nmi_work to see
 // why we need it.
 extern "C" uint8 iret_to_user;
+
+// The instructions in Ec::ret_user_sysexit that return to user space via SYSRET. Check
+// Ec::handle_exc_altstack to see why we need them.
+extern "C" uint8 sysret_to_user_begin;
+extern "C" uint8 sysret_to_user_end;
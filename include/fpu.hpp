@@ -50,9 +50,20 @@ private:
         uint8 fpu_data[FXSAVE_AREA_SIZE - FXSAVE_HEADER_SIZE];
     };
 
+    struct XsaveHdr { // Intel SDM Vol. 1 Chap. 13.4.2
+        uint64 xstate_bv;
+        uint64 xcomp_bv;
+        uint64 reserved[6];
+    };
+    static_assert(sizeof(XsaveHdr) == 64);
+
+    // Set in XCOMP_BV if the context is in the compacted format.
+    static constexpr uint64 XCOMP_BV_COMPACT{1ull << 63};
+
     struct FpuCtx {
         FxsaveHdr legacy_hdr;
         FxsaveData legacy_data;
+        XsaveHdr xsave_hdr;
     };
     static_assert(sizeof(FpuCtx) <= PAGE_SIZE, "FpuCtx has to fit into a kernel page.");
 
@@ -61,6 +72,8 @@ private:
 
     enum class Mode : uint8
     {
+        XSAVES,
+        XSAVEC,
         XSAVEOPT,
         XSAVE,
     };
@@ -69,11 +82,24 @@ private:
         uint64 xsave_scb; // State-Component Bitmap
         size_t context_size;
         Mode mode;
+        Mode compact_mode; // Same as mode if the CPU can't save in the compacted format.
     };
 
     static FpuConfig config;
 
+    Mode const mode_;
+
 public:
+    enum class Format : uint8
+    {
+        // The format that XSAVE uses. User space can access contexts in this format.
+        STANDARD,
+
+        // The compacted format of XSAVES or XSAVEC, if the CPU supports it. Components in their initial
+        // configuration are neither saved nor restored, so a context only costs what its EC actually uses.
+        COMPACT,
+    };
+
     static void probe();
     static void init();
 
@@ -90,6 +116,6 @@ public:
     static bool load_xcr0(uint64 xcr0);
     static void restore_xcr0();
 
-    explicit Fpu(Kp* data_kp);
+    Fpu(Kp* data_kp, Format format);
     ~Fpu() = default;
 };
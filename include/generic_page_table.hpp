@@ -225,7 +225,9 @@ private:
             // superpage.
             if (is_superpage(cur_level, entry)) {
                 fill_from_superpage(new_page, entry, cur_level);
-                cleanup.flush_tlb_later();
+
+                virt_t const superpage_mask{(static_cast<virt_t>(1) << level_order(cur_level)) - 1};
+                cleanup.flush_tlb_later(vaddr & ~superpage_mask);
             }
 
             // If we fail to install a pointer to the new page, we can
@@ -245,31 +247,35 @@ private:
                                    create);
     }
 
-    // Free any page tables referenced from a page table entry.
+    // Free any page tables referenced from a page table entry and schedule
+    // the invalidation of any TLB entries derived from it. vaddr is the
+    // virtual address the entry maps.
     //
     // Assumes that the given page table entry is already removed from the
     // page table.
-    NOINLINE void cleanup(DEFERRED_CLEANUP& cleanup_state, pte_t pte, level_t cur_level)
+    NOINLINE void cleanup(DEFERRED_CLEANUP& cleanup_state, pte_t pte, level_t cur_level, virt_t vaddr)
     {
         assert_slow(cur_level >= 0 and cur_level < max_levels_);
 
         if (is_leaf(cur_level, pte)) {
             if (pte & ATTR::PTE_P) {
-                cleanup_state.flush_tlb_later();
+                cleanup_state.flush_tlb_later(vaddr);
             }
         } else {
-            cleanup_table(cleanup_state, page_alloc_.phys_to_pointer(pte & ~ATTR::mask), cur_level);
+            cleanup_table(cleanup_state, page_alloc_.phys_to_pointer(pte & ~ATTR::mask), cur_level, vaddr);
         }
     }
 
     // Free any page tables referenced from the given page table including
     // itself. Companion function to cleanup().
-    void cleanup_table(DEFERRED_CLEANUP& cleanup_state, pte_pointer_t table, level_t cur_level)
+    void cleanup_table(DEFERRED_CLEANUP& cleanup_state, pte_pointer_t table, level_t cur_level, virt_t vaddr)
     {
         assert_slow(cur_level > 0 and cur_level <= max_levels_);
 
         for (size_t i{0}; i < static_cast<size_t>(1) << BITS_PER_LEVEL; i++) {
-            cleanup(cleanup_state, memory_.read(table + i), cur_level - 1);
+            virt_t const entry_vaddr{vaddr + (static_cast<virt_t>(i) << level_order(cur_level - 1))};
+
+            cleanup(cleanup_state, memory_.read(table + i), cur_level - 1, entry_vaddr);
         }
 
         cleanup_state.free_later(table);
@@ -310,7 +316,7 @@ private:
                 pte_t const new_attr{map.attr | (create_superpages ? static_cast<pte_t>(ATTR::PTE_S) : 0)};
                 pte_t const new_pte{clear_mappings ? 0 : (map.paddr | addr_offset | new_attr)};
 
-                cleanup(cleanup_state, memory_.exchange(pte_p, new_pte), cur_level);
+                cleanup(cleanup_state, memory_.exchange(pte_p, new_pte), cur_level, map.vaddr + addr_offset);
             } else {
             retry:
 
@@ -328,7 +334,7 @@ private:
                         goto retry;
                     }
 
-                    cleanup(cleanup_state, old_pte, cur_level);
+                    cleanup(cleanup_state, old_pte, cur_level, map.vaddr + addr_offset);
                     old_pte = new_pte;
                 }
 
@@ -527,7 +533,7 @@ public:
         }
 
         DEFERRED_CLEANUP cleanup_state;
-        cleanup_table(cleanup_state, root_, max_levels_);
+        cleanup_table(cleanup_state, root_, max_levels_, 0);
 
         cleanup_state.ignore_tlb_flush();
         cleanup_state.free_pages_now();
@@ -0,0 +1,355 @@
+/*
+ * Slab Allocator
+ *
+ * Copyright (C) 2009-2011 Udo Steinberg <udo@hypervisor.org>
+ * Economic rights: Technische Universitaet Dresden (Germany)
+ *
+ * Copyright (C) 2012 Udo Steinberg, Intel Corporation.
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "assert.hpp"
+#include "compiler.hpp"
+#include "math.hpp"
+#include "memory.hpp"
+#include "page_cache.hpp"
+#include "types.hpp"
+#include "util.hpp"
+
+// The slab allocator is a template to be able to test it on the host. The environment is described by the
+// POLICY class template parameter, which must provide:
+//
+// - lock_t and lock_guard_t: The lock that protects the list of slabs and a scoped guard for it.
+// - alloc_page() and free_page(ptr): Allocation of the pages that back the slabs.
+// - use_magazines(): Whether the per-CPU magazines can be used at the moment.
+// - alloc_magazine(size): Memory for a magazine of the current CPU. Magazines are never freed.
+// - cpu_id() and NUM_CPUS: The index of the current CPU and the number of possible CPUs.
+//
+// The kernel instantiation is Slab_cache (see slab.hpp).
+
+template <typename POLICY> class Generic_slab_cache;
+
+/**
+ * A slab is one page of memory that is split up into a number of fixed size elements. As long as an
+ * element is not used, it holds a pointer to another unused element, i.e. this implementation uses a free
+ * list to find unallocated elements.
+ */
+template <typename POLICY> class Generic_slab
+{
+    using cache_t = Generic_slab_cache<POLICY>;
+
+public:
+    unsigned long avail; // The amount of free elements in this slab
+    cache_t* cache;
+    Generic_slab* prev; // Prev slab in cache
+    Generic_slab* next; // Next slab in cache
+    char* head;         // A pointer to the start of this slab's free list
+
+    // The front-end allocator will initialize memory.
+    static inline void* operator new(size_t) { return POLICY::alloc_page(); }
+
+    static inline void operator delete(void* ptr) { POLICY::free_page(ptr); }
+
+    explicit Generic_slab(cache_t* slab_cache)
+        : avail(slab_cache->elem), cache(slab_cache), prev(nullptr), next(nullptr), head(nullptr)
+    {
+        char* link = reinterpret_cast<char*>(this) + PAGE_SIZE - cache->buff + cache->size;
+
+        for (unsigned long i = avail; i; i--, link -= cache->buff) {
+            *reinterpret_cast<char**>(link) = head;
+            head = link;
+        }
+    }
+
+    inline bool full() const { return !avail; }
+
+    inline bool empty() const { return avail == cache->elem; }
+
+    // Enqueues this slab between new_prev and new_next. Panics if new_prev and new_next are not adjacent.
+    void enqueue(Generic_slab* new_prev, Generic_slab* new_next)
+    {
+        next = new_next;
+        prev = new_prev;
+
+        // To make sure that we don't screw up the list of slabs when we enqueue a new slab, we assert that
+        // new_prev was the predecessor of new_next, and that new_next was the successor of new_prev.
+
+        if (new_next != nullptr) {
+            assert(new_next->prev == new_prev);
+            new_next->prev = this;
+        }
+
+        if (new_prev != nullptr) {
+            assert(new_prev->next == new_next);
+            new_prev->next = this;
+        }
+    }
+
+    // Dequeues this slab. After dequeueing, this slab can't be found in the list of slabs anymore, but this
+    // slab keeps its next and prev pointers.
+    void dequeue()
+    {
+        if (prev != nullptr) {
+            prev->next = next;
+        }
+
+        if (next != nullptr) {
+            next->prev = prev;
+        }
+    }
+
+    inline void* alloc()
+    {
+        avail--;
+
+        void* link = reinterpret_cast<void*>(head - cache->size);
+        head = *reinterpret_cast<char**>(head);
+        return link;
+    }
+
+    inline void free(void* ptr)
+    {
+        avail++;
+
+        char* link = reinterpret_cast<char*>(ptr) + cache->size;
+        *reinterpret_cast<char**>(link) = head;
+        head = link;
+    }
+};
+
+/**
+ * The slab cache is an allocator for fixed size objects that are smaller than a page. The slab cache holds a
+ * list of slabs. If the slab cache is full, i.e. all elements are allocated, it allocates a new, empty slab.
+ * The slab cache holds at most one completely free slab and returns further ones as they become empty.
+ *
+ * In front of the list of slabs, each CPU has a magazine of free elements. Allocations and deallocations
+ * are served from the magazine of the current CPU without taking the lock. Only when a magazine runs empty
+ * or overflows, a batch of elements is exchanged with the list of slabs while taking the lock once.
+ *
+ * Elements can be freed on any CPU. They end up in the magazine of the freeing CPU and find their way back
+ * to their slab when that magazine is drained.
+ */
+template <typename POLICY> class Generic_slab_cache
+{
+public:
+    using slab_t = Generic_slab<POLICY>;
+
+    // The number of free elements each CPU can hold in its magazine.
+    static constexpr size_t MAGAZINE_SIZE{16};
+
+    using magazine_t = Page_cache<MAGAZINE_SIZE>;
+
+private:
+    typename POLICY::lock_t lock;
+
+    // The slab that will be used for the next allocation, or a nullptr if the the slab cache is full.
+    slab_t* curr{nullptr};
+    slab_t* head{nullptr}; // The head of our list of slabs.
+
+    // Magazines are only touched by their own CPU. Each CPU allocates its magazine when it first uses this
+    // slab cache, so CPUs that are not present only cost a pointer.
+    magazine_t* magazines[POLICY::NUM_CPUS]{};
+
+    magazine_t& magazine()
+    {
+        magazine_t*& m{magazines[POLICY::cpu_id()]};
+
+        if (EXPECT_FALSE(m == nullptr)) {
+            m = new (POLICY::alloc_magazine(sizeof(magazine_t))) magazine_t;
+        }
+
+        return *m;
+    }
+
+    /*
+     * Back end allocator
+     */
+    void grow()
+    {
+        slab_t* slab = new slab_t(this);
+        slab->enqueue(nullptr, head);
+
+        head = slab;
+        curr = slab;
+    }
+
+    // Allocate an element from the list of slabs. The caller must hold the lock.
+    void* alloc_locked()
+    {
+        if (EXPECT_FALSE(!curr)) {
+            grow();
+        }
+
+        assert(!curr->full());
+        assert(!curr->next || curr->next->full());
+
+        // Allocate from slab
+        void* ret = curr->alloc();
+
+        if (EXPECT_FALSE(curr->full())) {
+            // curr always points to the slab that will be used for the next allocation. If curr is full, we
+            // have to move it to curr-prev. If curr has no prev, curr will be a nullptr and the next
+            // allocation will call grow, which makes curr and head point to an empty slab.
+            curr = curr->prev;
+        }
+
+        return ret;
+    }
+
+    // Return an element to its slab. The caller must hold the lock.
+    void free_locked(void* ptr)
+    {
+        // We can assert that head != nullptr here, because this can only happen if
+        // someone calls free before calling alloc at least once, which is a bug.
+        assert(head != nullptr);
+
+        // The slab that holds the element that will be free'd. In the following comments it will be refered
+        // to as 'this slab'.
+        slab_t* slab = reinterpret_cast<slab_t*>(reinterpret_cast<mword>(ptr) & ~PAGE_MASK);
+
+        const bool was_full = slab->full();
+
+        slab->free(ptr); // Deallocate from slab
+
+        // The list of slabs is ordered so that all full slabs come after curr, and all partial or free slabs
+        // come before curr. We will reorder the list if necessary.
+
+        if (EXPECT_FALSE(was_full)) {
+            // This slab was full and is now partial. We will make curr point to it.
+
+            if (slab->prev && slab->prev->full()) {
+                // This slab's predecessor is full, thus we have to requeue it to make the above explained
+                // invariant hold true.
+                slab->dequeue();
+
+                if (curr) {
+                    // curr is not a nullptr. We enqueue this slab between curr and curr's successor (which is
+                    // a full slab).
+                    slab->enqueue(curr, curr->next);
+                } else {
+                    // curr is a nullptr, i.e. all slabs (except for this slab) are full. We enqueue this slab
+                    // as the new head.
+                    slab->enqueue(nullptr, head);
+                    head = slab;
+                }
+            }
+
+            curr = slab;
+
+        } else if (EXPECT_FALSE(slab->empty())) {
+            // We want the slab cache to delete empty pages when a free leads to more than one empty slab in
+            // our list of slabs. To ease checking for an empty slab, head always points to the empty slab in
+            // the list if one exists.
+
+            if (slab->prev == nullptr) {
+                // This slab is now empty and has no prev, i.e. it is already the head. Thus we can just
+                // leave.
+                assert(slab == head);
+                return;
+            }
+
+            if (slab == curr) {
+                // This slab shouldn't be curr, because it will be either deleted or moved to the head.
+                assert(slab->prev != nullptr);
+                curr = slab->prev;
+            }
+
+            slab->dequeue();
+
+            if (slab->prev->empty() || head->empty()) {
+                // There are already empty slabs, thus we delete this slab.
+                assert(head != slab);
+                delete slab;
+            } else {
+                // There is currently no empty slab, thus we enqueue this slab as the new head.
+                slab->enqueue(nullptr, head);
+                head = slab;
+            }
+        }
+    }
+
+    // Refill a magazine with n elements while acquiring the lock only once.
+    size_t alloc_batch(mword* elems, size_t n)
+    {
+        typename POLICY::lock_guard_t guard(lock);
+
+        for (size_t i{0}; i < n; i++) {
+            elems[i] = reinterpret_cast<mword>(alloc_locked());
+        }
+
+        return n;
+    }
+
+    // Return elements from a magazine to their slabs while acquiring the lock only once.
+    void free_batch(mword const* elems, size_t n)
+    {
+        typename POLICY::lock_guard_t guard(lock);
+
+        for (size_t i{0}; i < n; i++) {
+            free_locked(reinterpret_cast<void*>(elems[i]));
+        }
+    }
+
+public:
+    unsigned long size; // Size of an element
+    unsigned long buff; // Size of an element buffer (includes link field)
+    unsigned long elem; // Number of elements that one slab can hold
+
+    Generic_slab_cache(unsigned long elem_size, unsigned elem_align)
+        : size(align_up(elem_size, sizeof(mword))), buff(align_up(size + sizeof(mword), elem_align)),
+          elem((PAGE_SIZE - sizeof(slab_t)) / buff)
+    {
+    }
+
+    /*
+     * Front end allocator
+     *
+     * The content of the returned element is undefined.
+     */
+    void* alloc()
+    {
+        if (EXPECT_TRUE(POLICY::use_magazines())) {
+            return reinterpret_cast<void*>(
+                magazine().alloc([this](mword* elems, size_t n) { return alloc_batch(elems, n); }));
+        }
+
+        typename POLICY::lock_guard_t guard(lock);
+        return alloc_locked();
+    }
+
+    /*
+     * Front end deallocator
+     */
+    void free(void* ptr)
+    {
+        if (EXPECT_TRUE(POLICY::use_magazines())) {
+            magazine().free(reinterpret_cast<mword>(ptr),
+                            [this](mword const* elems, size_t n) { free_batch(elems, n); });
+            return;
+        }
+
+        typename POLICY::lock_guard_t guard(lock);
+        free_locked(ptr);
+    }
+
+    // Return all elements in the magazine of the current CPU to their slabs.
+    void drain_magazine()
+    {
+        if (POLICY::use_magazines() and magazines[POLICY::cpu_id()] != nullptr) {
+            magazine().drain_all([this](mword const* elems, size_t n) { free_batch(elems, n); });
+        }
+    }
+};
@@ -38,6 +38,7 @@ public:
         SM,
         KP,
         VCPU,
+        NOTIFICATION,
     };
 
     inline Type type() const { return objtype; }
@@ -92,9 +92,10 @@ public:
     // Adds a user space mapping for this kernel page. This includes adding a
     // RCU reference to the destination PD and mapping the memory at the given
     // address.
+    // The mapping is read-only unless writable is true.
     // Returns true if the mapping was successful, i.e. if no mapping
     // existed and if the given address is valid. Otherwise returns false.
-    bool add_user_mapping(Pd* pd, mword addr);
+    bool add_user_mapping(Pd* pd, mword addr, bool writable = true);
 
     // Removes the current user space mapping. If no user space mapping exists,
     // this function does nothing and returns false. Returns true otherwise.
@@ -81,26 +81,59 @@ private:
         MASKED = 1U << 16,
     };
 
+    enum Apic_base
+    {
+        APIC_BASE_BSP = 1U << 8,
+        APIC_BASE_EXTD = 1U << 10,
+        APIC_BASE_EN = 1U << 11,
+    };
+
+    // In x2APIC mode, the LAPIC registers are accessed as MSRs. The MSR index of each register is its xAPIC
+    // MMIO offset divided by 16, which is how Register is encoded.
+    static inline Msr::Register x2apic_msr(Register reg)
+    {
+        return static_cast<Msr::Register>(static_cast<unsigned>(Msr::IA32_EXT_XAPIC) + reg);
+    }
+
     static inline uint32 read(Register reg)
     {
+        if (x2apic) {
+            return static_cast<uint32>(Msr::read(x2apic_msr(reg)));
+        }
+
         return *reinterpret_cast<uint32 volatile*>(CPU_LOCAL_APIC + (reg << 4));
     }
 
     static inline void write(Register reg, uint32 val)
     {
+        if (x2apic) {
+            Msr::write(x2apic_msr(reg), val);
+            return;
+        }
+
         *reinterpret_cast<uint32 volatile*>(CPU_LOCAL_APIC + (reg << 4)) = val;
     }
 
     static inline void wait_for_idle()
     {
+        // There is no delivery status in x2APIC mode.
+        assert_slow(not x2apic);
+
         while (EXPECT_FALSE(read(LAPIC_ICR_LO) & 1U << 12)) {
             relax();
         }
     }
 
+    static void send_ipi_x2apic(unsigned cpu, uint32 icr_lo, Shorthand dsh);
+
+    static void send_ipi_xapic(unsigned cpu, uint32 icr_lo, Shorthand dsh);
+
 public:
     static unsigned freq_tsc;
 
+    // Whether all LAPICs operate in x2APIC mode. This is decided by the BSP in init and then stays constant.
+    static inline bool x2apic;
+
     // Number of CPUs that still need to be parked.
     //
     // See park_all_but_self.
@@ -116,7 +149,7 @@ public:
     // Prepares a CPU to be parked and parks it.
     [[noreturn]] static void park_handler();
 
-    static inline unsigned id() { return read(LAPIC_IDR) >> 24 & 0xff; }
+    static inline unsigned id() { return x2apic ? read(LAPIC_IDR) : read(LAPIC_IDR) >> 24 & 0xff; }
 
     // This is a special version of id() that already works when the LAPIC
     // is not mapped yet.
@@ -163,6 +196,16 @@ public:
     // not send an NMI and return false. Otherwise returns true.
     static bool send_nmi(unsigned cpu);
 
+    // Ask a remote CPU to handle the given hazards as soon as possible.
+    //
+    // The hazards are set on the remote CPU and an NMI is sent to it, unless another NMI is already on its
+    // way. This coalesces concurrent requests (e.g. a TLB shootdown, an RCU acceleration and a remote wakeup)
+    // into a single NMI. The remote CPU acknowledges the NMI in Ec::do_early_nmi_work.
+    //
+    // Returns false, if the remote CPU might lose NMIs (see send_nmi). Otherwise the remote CPU is guaranteed
+    // to go through Ec::do_early_nmi_work after this call.
+    static bool kick(unsigned cpu, unsigned hazards);
+
     // Stop all CPUs except the current one.
     //
     // Parked CPUs execute the passed function and all but the calling CPU
@@ -93,6 +93,7 @@ public:
         IA32_DS_AREA = 0x600,
         IA32_TSC_DEADLINE = 0x6e0,
         IA32_EXT_XAPIC = 0x800,
+        IA32_EXT_XAPIC_ICR = 0x830,
         IA32_EXT_XAPIC_END = 0x8ff,
         IA32_EFER = 0xc0000080,
         IA32_STAR = 0xc0000081,
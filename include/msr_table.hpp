@@ -0,0 +1,120 @@
+/*
+ * MSR Table for vCPUs
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "memory.hpp"
+#include "types.hpp"
+
+// An MSR that the kernel emulates for a vCPU as the VMM provides it in the MSR table page.
+struct Msr_table_entry {
+    enum Flags : uint32
+    {
+        // The entry is in use. The table ends at the first unused entry.
+        VALID = 1U << 0,
+
+        // Reads return the stored value.
+        READ = 1U << 1,
+
+        // Writes update the bits of the stored value that are set in the write mask. Writes to other bits are
+        // ignored.
+        WRITE = 1U << 2,
+
+        // Writes signal the notification bit in bits 13:8 of the flags.
+        NOTIFY = 1U << 3,
+
+        NOTIFY_BIT_SHIFT = 8,
+        NOTIFY_BIT_MASK = 0x3fU << NOTIFY_BIT_SHIFT,
+    };
+
+    uint32 index, flags;
+    uint64 value, write_mask, reserved;
+};
+static_assert(sizeof(Msr_table_entry) == 32, "MSR table entry layout is part of the ABI.");
+
+// A page of MSRs that the VMM fills to let the kernel handle RDMSR and WRMSR exits without a round trip to the
+// VMM.
+//
+// The VMM owns the memory and can modify it at any time. Each entry is accessed field by field, so a
+// concurrent modification can at worst result in a mix of old and new values of a single entry. The kernel
+// stores written values back into the table, so the VMM always finds the current value there.
+class Msr_table
+{
+public:
+    static constexpr size_t ENTRIES{PAGE_SIZE / sizeof(Msr_table_entry)};
+
+    explicit Msr_table(void* page) : entries(static_cast<Msr_table_entry*>(page)) {}
+
+    // Emulates a read of the given MSR. Returns false if the VMM has to handle the read.
+    bool read(uint32 index, uint64& value) const
+    {
+        volatile Msr_table_entry* e{find(index, Msr_table_entry::READ)};
+
+        if (not e) {
+            return false;
+        }
+
+        value = e->value;
+        return true;
+    }
+
+    // Emulates a write of the given MSR. Returns false if the VMM has to handle the write. Otherwise, notify
+    // holds the notification bits to signal, which may be none.
+    bool write(uint32 index, uint64 value, uint64& notify) const
+    {
+        volatile Msr_table_entry* e{find(index, Msr_table_entry::WRITE)};
+
+        if (not e) {
+            return false;
+        }
+
+        const uint64 mask{e->write_mask};
+        const uint32 flags{e->flags};
+
+        e->value = (e->value & ~mask) | (value & mask);
+
+        notify = 0;
+        if (flags & Msr_table_entry::NOTIFY) {
+            notify = static_cast<uint64>(1)
+                     << ((flags & Msr_table_entry::NOTIFY_BIT_MASK) >> Msr_table_entry::NOTIFY_BIT_SHIFT);
+        }
+
+        return true;
+    }
+
+private:
+    // Returns the entry of the given MSR if it permits the given access.
+    volatile Msr_table_entry* find(uint32 index, uint32 access) const
+    {
+        for (size_t i{0}; i < ENTRIES; i++) {
+            volatile Msr_table_entry* e{&entries[i]};
+            const uint32 flags{e->flags};
+
+            if (not(flags & Msr_table_entry::VALID)) {
+                break;
+            }
+
+            if (e->index == index) {
+                return (flags & access) ? e : nullptr;
+            }
+        }
+
+        return nullptr;
+    }
+
+    Msr_table_entry* entries;
+};
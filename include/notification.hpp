@@ -0,0 +1,127 @@
+/*
+ * Notification
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "ec.hpp"
+
+// A notification is a word of pending bits. Signaling ORs bits into the word and waiting takes all pending bits
+// at once. Unlike a semaphore, a waiter learns which of many event sources fired, and many events can be
+// signaled with a single system call.
+class Notification : public Typed_kobject<Kobject::Type::NOTIFICATION>, public Refcount, public Queue<Ec>
+{
+private:
+    // The bits that were signaled since the last wait returned.
+    uint64 pending{0};
+
+    static Slab_cache cache;
+
+    // Wake up all waiting ECs with BAD_CAP. Other references, such as the MSR table notification of a vCPU, can
+    // keep the notification alive after its capability is gone, so this cannot wait for the destructor.
+    inline void revoke_waiters()
+    {
+        for (Ec* ec;;) {
+            {
+                Lock_guard<Spinlock> guard(lock);
+
+                if (!dequeue(ec = head()))
+                    return;
+            }
+
+            ec->release(Ec::sys_finish<Sys_regs::BAD_CAP>);
+
+            if (ec->del_rcu())
+                Rcu::call(ec);
+        }
+    }
+
+    static void free(Rcu_elem* a)
+    {
+        Notification* n = static_cast<Notification*>(a);
+
+        // The capability is gone and the grace period has passed, so no EC can start to wait anymore.
+        n->revoke_waiters();
+
+        if (n->del_ref())
+            delete n;
+    }
+
+public:
+    // Capability permission bitmask.
+    enum
+    {
+        PERM_SIGNAL = 1U << 0,
+        PERM_WAIT = 1U << 1,
+
+        PERM_ALL = PERM_SIGNAL | PERM_WAIT,
+    };
+
+    Notification(Pd*, mword);
+
+    ~Notification() { revoke_waiters(); }
+
+    // Set the given bits and wake up a waiting EC, which then takes all pending bits.
+    inline void signal(uint64 bits)
+    {
+        Atomic::set_mask(pending, bits);
+
+        Ec* ec = nullptr;
+
+        do {
+            if (ec)
+                Rcu::call(ec);
+
+            {
+                Lock_guard<Spinlock> guard(lock);
+
+                if (!dequeue(ec = head()))
+                    return;
+            }
+
+            ec->release(nullptr);
+
+        } while (EXPECT_FALSE(ec->del_rcu()));
+    }
+
+    // Take all pending bits. If there are none, the current EC blocks until the next signal and then resumes at
+    // its continuation, which has to retry the wait.
+    inline uint64 wait()
+    {
+        Ec* const ec{Ec::current()};
+
+        {
+            Lock_guard<Spinlock> guard(lock);
+
+            if (uint64 const bits{Atomic::exchange(pending, uint64{0})}; bits)
+                return bits;
+
+            bool ok = ec->add_ref();
+            assert(ok);
+
+            enqueue(ec);
+        }
+
+        ec->block_sc();
+
+        // A signal arrived before we blocked.
+        ec->return_to_user();
+    }
+
+    static inline void* operator new(size_t) { return cache.alloc(); }
+
+    static inline void operator delete(void* ptr) { cache.free(ptr); }
+};
@@ -0,0 +1,142 @@
+/*
+ * Per-CPU Page Cache
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "assert.hpp"
+#include "compiler.hpp"
+#include "page_cache_stats.hpp"
+#include "types.hpp"
+
+// A cache of free pages in front of a global page allocator.
+//
+// Each CPU owns one of these caches and serves single-page allocations from it without taking the lock of
+// the global allocator. When the cache runs empty, it is refilled with a batch of pages from the global
+// allocator. When it overflows, a batch of pages is returned. Each refill and drain only takes the global
+// lock once.
+//
+// The cache itself is not synchronized. Only its owning CPU may use it.
+template <size_t CAPACITY> class Page_cache
+{
+public:
+    static_assert(CAPACITY >= 2 and CAPACITY % 2 == 0, "Capacity must be an even number");
+
+    // The number of pages that are moved from or to the global allocator at once.
+    static constexpr size_t BATCH{CAPACITY / 2};
+
+private:
+    // Free pages. The most recently freed page is at the top and is handed out first, because it is most
+    // likely still in the cache.
+    mword pages_[CAPACITY];
+    size_t count_{0};
+
+    uint64 hits_{0};
+    uint64 misses_{0};
+    uint64 taken_{0};
+
+    template <typename REFILL> mword refill_and_pop(REFILL&& refill)
+    {
+        count_ = refill(pages_, BATCH);
+        assert(count_ <= BATCH);
+
+        return count_ != 0 ? pages_[--count_] : 0;
+    }
+
+public:
+    // The number of allocations that were served from the cache.
+    uint64 hits() const { return hits_; }
+
+    // The number of allocations that needed a refill from the global allocator.
+    uint64 misses() const { return misses_; }
+
+    // The number of pages that were handed out with take.
+    uint64 taken() const { return taken_; }
+
+    // The number of pages currently in the cache.
+    size_t count() const { return count_; }
+
+    bool full() const { return count_ == CAPACITY; }
+
+    // Take a page from the cache.
+    //
+    // If the cache is empty, refill(pages, n) is called to get up to n pages from the global allocator. It
+    // must return the number of pages it stored in pages. Returns zero, if no page could be allocated.
+    template <typename REFILL> mword alloc(REFILL&& refill)
+    {
+        if (EXPECT_TRUE(count_ != 0)) {
+            hits_++;
+            return pages_[--count_];
+        }
+
+        misses_++;
+
+        return refill_and_pop(refill);
+    }
+
+    // Take a page like alloc, but count it separately instead of as a hit or miss.
+    //
+    // This is meant for pages that don't serve the kind of allocation the cache is meant for, so they don't
+    // skew its hit rate.
+    template <typename REFILL> mword take(REFILL&& refill)
+    {
+        mword const page{count_ != 0 ? pages_[--count_] : refill_and_pop(refill)};
+
+        if (page != 0) {
+            taken_++;
+        }
+
+        return page;
+    }
+
+    // Put a page into the cache.
+    //
+    // If the cache is full, drain(pages, n) is called to give the n least recently freed pages back to the
+    // global allocator.
+    template <typename DRAIN> void free(mword page, DRAIN&& drain)
+    {
+        if (EXPECT_FALSE(count_ == CAPACITY)) {
+            drain(static_cast<mword const*>(pages_), BATCH);
+
+            for (size_t i{BATCH}; i < CAPACITY; i++) {
+                pages_[i - BATCH] = pages_[i];
+            }
+
+            count_ -= BATCH;
+        }
+
+        pages_[count_++] = page;
+    }
+
+    // Give all pages back to the global allocator.
+    template <typename DRAIN> void drain_all(DRAIN&& drain)
+    {
+        if (count_ != 0) {
+            drain(static_cast<mword const*>(pages_), count_);
+            count_ = 0;
+        }
+    }
+};
+
+// Collect the counters of the page cache of a CPU and of its pool of pre-zeroed pages. The pages that are
+// taken from the page cache are the ones that were zeroed ahead of time. The pages that are taken from the
+// pool served allocations without FILL_0.
+template <size_t CAPACITY>
+Page_cache_stats page_cache_stats(Page_cache<CAPACITY> const& cache, Page_cache<CAPACITY> const& zeroed)
+{
+    return {cache.hits(), cache.misses(), cache.taken(), zeroed.hits(), zeroed.misses(), zeroed.taken(),
+            cache.count(), zeroed.count()};
+}
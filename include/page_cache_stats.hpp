@@ -0,0 +1,43 @@
+/*
+ * Page Cache Statistics
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "types.hpp"
+
+// The counters of the page caches of one CPU as machine_ctrl_page_cache_stats writes them into a KP.
+//
+// The counters are taken from another CPU without synchronization, so they may be slightly outdated and are
+// not consistent with each other.
+struct Page_cache_stats {
+    // Single-page allocations that were served from the page cache or needed a refill from the buddy
+    // allocator.
+    uint64 hits, misses;
+
+    // Pages that the idle loop took from the page cache to zero them ahead of time.
+    uint64 prezeroed;
+
+    // Allocations with FILL_0 that were or were not served with a pre-zeroed page.
+    uint64 zeroed_hits, zeroed_misses;
+
+    // Allocations without FILL_0 that took a pre-zeroed page, because the page cache ran empty.
+    uint64 zeroed_fallbacks;
+
+    // The number of pages in the page cache and the number of pre-zeroed pages.
+    uint64 pages, zeroed_pages;
+};
+static_assert(sizeof(Page_cache_stats) == 0x40, "Page cache statistics layout is part of the ABI.");
@@ -106,7 +106,7 @@ public:
         mword pcid = did;
 
         if (EXPECT_FALSE(stale_host_tlb.chk(Cpu::id())))
-            stale_host_tlb.clr(Cpu::id());
+            discard_stale_host_tlb();
 
         else {
 
@@ -161,6 +161,10 @@ public:
 
     Delegate_result<Xfer> xfer_item(Pd* src_pd, Crd xlt, Crd del, Xfer s_ti);
 
+    // Version of xfer_item that collects TLB invalidations in the given cleanup object instead of doing a
+    // shootdown on its own. The caller is responsible for the shootdown.
+    Delegate_result<Xfer> xfer_item(Tlb_cleanup& cleanup, Pd* src_pd, Crd xlt, Crd del, Xfer s_ti);
+
     // Bulk version of xfer_item that is used during IPC.
     //
     // When this function fails, items will be partially transferred.
@@ -169,8 +173,14 @@ public:
 
     void xlt_crd(Pd*, Crd, Crd&);
     Delegate_result_void del_crd(Pd* pd, Crd del, Crd& crd, mword sub = 0, mword hot = 0);
+    Delegate_result_void del_crd(Tlb_cleanup& cleanup, Pd* pd, Crd del, Crd& crd, mword sub, mword hot);
+
     void rev_crd(Crd, bool);
 
+    // Version of rev_crd that leaves the shootdown to the caller. Memory revocations always need a
+    // shootdown.
+    void rev_crd(Tlb_cleanup& cleanup, Crd, bool);
+
     // Returns true if the current PCID is valid. This can also mean that PCID is not enabled. Returns false
     // if PCID is enabled and the PCID has an invalid value.
     //
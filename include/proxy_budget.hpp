@@ -0,0 +1,66 @@
+/*
+ * Proxy SC Budget
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "atomic.hpp"
+
+// Counts the proxy SCs that run the handler EC of cross-CPU calls.
+//
+// One proxy SC can serve any number of calls one after the other, so callers only create a new one while there
+// are fewer than MAX. This keeps user space from making the kernel allocate SCs without bound. Calls that
+// don't get their own proxy SC are served by one of the existing ones.
+//
+// For this to work, a proxy SC that runs out of work must not leave a call behind that was queued just before
+// the proxy SC went away. The caller therefore queues its call before it asks for a new proxy SC, and the
+// proxy SC gives up its slot before it checks for new calls one last time. With sequentially consistent
+// atomics, at least one of them sees what the other did.
+template <unsigned MAX> class Proxy_budget
+{
+    unsigned count{0};
+
+public:
+    // Called by a caller after it has queued its call. Returns true, if the caller has to create a new proxy
+    // SC. Otherwise, an existing proxy SC takes care of the call.
+    bool try_add()
+    {
+        for (unsigned c{Atomic::load(count)}; c < MAX; c = Atomic::load(count)) {
+            if (Atomic::cmp_swap(count, c, c + 1)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Called by a proxy SC that found nothing left to do. The pending function returns whether calls have been
+    // queued in the meantime. Returns true, if the proxy SC can go away. Otherwise, the proxy SC keeps its
+    // slot and has to serve the new calls.
+    template <typename FN> bool try_remove(FN pending)
+    {
+        Atomic::sub(count, 1U);
+
+        if (not pending()) {
+            return true;
+        }
+
+        Atomic::add(count, 1U);
+        return false;
+    }
+
+    unsigned proxies() const { return Atomic::load(count); }
+};
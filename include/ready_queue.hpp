@@ -0,0 +1,124 @@
+/*
+ * Priority-ordered Ready Queue
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "assert.hpp"
+#include "math.hpp"
+#include "types.hpp"
+
+// A ready queue with a fixed number of priorities.
+//
+// Elements of the same priority are kept in a circular doubly-linked list and are served in FIFO order.
+// Additionally, we keep a bitmap of all priorities that have at least one element. This allows finding the
+// highest priority element with a bit scan instead of walking all priority levels.
+//
+// The element type T is linked intrusively and needs to provide prio, prev and next members that are
+// accessible to this class.
+template <typename T, unsigned PRIORITIES> class Ready_queue
+{
+    static constexpr unsigned BITS_PER_WORD{sizeof(mword) * 8};
+    static constexpr unsigned WORDS{(PRIORITIES + BITS_PER_WORD - 1) / BITS_PER_WORD};
+
+    // The head of the list for each priority. The head is the element that is dequeued next.
+    T* list[PRIORITIES]{};
+
+    // A bit is set for each priority that has a non-empty list.
+    mword nonempty[WORDS]{};
+
+    void mark(unsigned prio)
+    {
+        nonempty[prio / BITS_PER_WORD] |= static_cast<mword>(1) << (prio % BITS_PER_WORD);
+    }
+
+    void unmark(unsigned prio)
+    {
+        nonempty[prio / BITS_PER_WORD] &= ~(static_cast<mword>(1) << (prio % BITS_PER_WORD));
+    }
+
+public:
+    bool empty() const
+    {
+        for (mword w : nonempty) {
+            if (w) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // Return the highest priority that has a queued element or zero, if the queue is empty.
+    unsigned top_prio() const
+    {
+        for (unsigned i{WORDS}; i > 0; i--) {
+            if (nonempty[i - 1]) {
+                return static_cast<unsigned>((i - 1) * BITS_PER_WORD + bit_scan_reverse(nonempty[i - 1]));
+            }
+        }
+
+        return 0;
+    }
+
+    // Return the element that should run next or nullptr, if the queue is empty.
+    T* top() const { return list[top_prio()]; }
+
+    // Return the first element of the given priority or nullptr, if there is none.
+    T* head(unsigned prio) const
+    {
+        assert(prio < PRIORITIES);
+        return list[prio];
+    }
+
+    // Append an element to the end of the list of its priority.
+    void enqueue(T* t)
+    {
+        unsigned const prio{t->prio};
+        assert(prio < PRIORITIES);
+
+        if (!list[prio]) {
+            list[prio] = t->prev = t->next = t;
+            mark(prio);
+        } else {
+            t->next = list[prio];
+            t->prev = list[prio]->prev;
+            t->next->prev = t->prev->next = t;
+        }
+    }
+
+    // Remove an element from the queue.
+    //
+    // The element must be currently enqueued.
+    void dequeue(T* t)
+    {
+        unsigned const prio{t->prio};
+        assert(prio < PRIORITIES);
+        assert(t->prev and t->next);
+
+        if (list[prio] == t) {
+            list[prio] = t->next == t ? nullptr : t->next;
+
+            if (!list[prio]) {
+                unmark(prio);
+            }
+        }
+
+        t->next->prev = t->prev;
+        t->prev->next = t->next;
+        t->prev = t->next = nullptr;
+    }
+};
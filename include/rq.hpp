@@ -7,6 +7,7 @@
  * Copyright (C) 2012-2013 Udo Steinberg, Intel Corporation.
  * Copyright (C) 2014 Udo Steinberg, FireEye, Inc.
  * Copyright (C) 2013-2014 Alexander Boettcher, Genode Labs GmbH
+ * Copyright (C) 2026 Cyberus Technology GmbH.
  *
  * This file is part of the Hedron hypervisor.
  *
@@ -22,11 +23,66 @@
 
 #pragma once
 
-#include "spinlock.hpp"
+#include "atomic.hpp"
 
 class Sc;
 
-struct Rq {
-    Spinlock lock;
-    Sc* queue;
+// A lock-free multi-producer single-consumer queue.
+//
+// Producers push elements with a single compare-and-swap and never wait for the consumer or for each other to
+// leave a critical section. The consumer takes all queued elements at once with a single atomic exchange.
+// Because elements are never removed individually, the queue does not suffer from the ABA problem.
+//
+// Elements are linked intrusively via their next member, which must be accessible to this class.
+template <typename T> class Mpsc_queue
+{
+    // The most recently enqueued element. Elements are linked from newest to oldest.
+    T* head{nullptr};
+
+public:
+    // Add an element to the queue.
+    //
+    // Returns true, if the queue was empty before. Exactly one producer observes this transition for each
+    // batch of elements that is taken by the consumer, so it can be used to notify the consumer.
+    bool enqueue(T* t)
+    {
+        T* old;
+
+        do {
+            old = Atomic::load(head);
+            t->next = old;
+        } while (not Atomic::cmp_swap(head, old, t));
+
+        return old == nullptr;
+    }
+
+    // Remove all elements from the queue and call fn on each of them in the order they were enqueued.
+    //
+    // The next member of each element is cleared before fn is called, so fn is free to link the element
+    // elsewhere. This function must only be called by the single consumer.
+    template <typename FN> void drain(FN fn)
+    {
+        T* lifo{Atomic::exchange<T*, Atomic::ACQUIRE>(head, nullptr)};
+
+        // Reverse the list to restore FIFO order.
+        T* fifo{nullptr};
+        while (lifo) {
+            T* const n{lifo->next};
+            lifo->next = fifo;
+            fifo = lifo;
+            lifo = n;
+        }
+
+        while (fifo) {
+            T* const n{fifo->next};
+            fifo->next = nullptr;
+            fn(fifo);
+            fifo = n;
+        }
+    }
+
+    bool empty() const { return Atomic::load(head) == nullptr; }
 };
+
+// The queue of SCs that other CPUs have made ready on this CPU.
+using Rq = Mpsc_queue<Sc>;
@@ -31,6 +31,8 @@ class Ec;
 class Sc : public Typed_kobject<Kobject::Type::SC>, public Refcount
 {
     friend class Queue<Sc>;
+    friend class Ready_queue<Sc, NUM_PRIORITIES>;
+    friend class Mpsc_queue<Sc>;
 
 public:
     Refptr<Ec> const ec;
@@ -45,8 +47,7 @@ private:
     static Slab_cache cache;
 
     CPULOCAL_REMOTE_ACCESSOR(sc, rq);
-    CPULOCAL_ACCESSOR(sc, list);
-    CPULOCAL_ACCESSOR(sc, prio_top);
+    CPULOCAL_ACCESSOR(sc, ready);
 
     void ready_enqueue(uint64, bool);
 
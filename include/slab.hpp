@@ -21,34 +21,34 @@
 #pragma once
 
 #include "buddy.hpp"
+#include "config.hpp"
+#include "generic_slab.hpp"
 #include "initprio.hpp"
+#include "spinlock.hpp"
 
-class Slab;
+template <typename T> class Lock_guard;
 
-/**
- * The slab cache is an allocator for fixed size objects that are smaller than a page. The slab cache holds a
- * list of slabs. If the slab cache is full, i.e. all elements are allocated, it allocates a new, empty slab.
- * The slab cache holds at most one completely free slab and returns further ones as they become empty.
- */
-class Slab_cache
-{
-private:
-    Spinlock lock;
+// The environment of the kernel's slab allocator. See Generic_slab_cache.
+struct Slab_policy {
+    using lock_t = Spinlock;
+    using lock_guard_t = Lock_guard<Spinlock>;
 
-    // The slab that will be used for the next allocation, or a nullptr if the the slab cache is full.
-    Slab* curr;
-    Slab* head; // The head of our list of slabs.
+    static constexpr unsigned NUM_CPUS{NUM_CPU};
 
-    /*
-     * Back end allocator
-     */
-    void grow();
+    static void* alloc_page();
+    static void free_page(void* ptr);
 
-public:
-    unsigned long size; // Size of an element
-    unsigned long buff; // Size of an element buffer (includes link field)
-    unsigned long elem; // Number of elements that one slab can hold
+    // Magazines are indexed by the current CPU, which is only known once CPU-local memory is set up.
+    static bool use_magazines();
+    static unsigned cpu_id();
+
+    // The magazines of all slab caches of a CPU share the pages in Per_cpu::slab_magazine_mem.
+    static void* alloc_magazine(size_t size);
+};
 
+class Slab_cache : public Generic_slab_cache<Slab_policy>
+{
+public:
     Slab_cache(unsigned long elem_size, unsigned elem_align);
 
     /*
@@ -61,43 +61,3 @@ public:
      */
     void free(void* ptr);
 };
-
-/**
- * A slab is one page of memory that is split up into a number of fixed size elements. As long as an
- * element is not used, it holds a pointer to another unused element, i.e. this implementation uses a free
- * list to find unallocated elements.
- */
-class Slab
-{
-public:
-    unsigned long avail; // The amount of free elements in this slab
-    Slab_cache* cache;
-    Slab* prev; // Prev slab in cache
-    Slab* next; // Next slab in cache
-    char* head; // A pointer to the start of this slab's free list
-
-    static inline void* operator new(size_t)
-    {
-        // The front-end allocator will initialize memory.
-        return Buddy::allocator.alloc(0, Buddy::NOFILL);
-    }
-
-    static inline void operator delete(void* ptr) { Buddy::allocator.free(reinterpret_cast<mword>(ptr)); }
-
-    Slab(Slab_cache* slab_cache);
-
-    inline bool full() const { return !avail; }
-
-    inline bool empty() const { return avail == cache->elem; }
-
-    // Enqueues this slab between new_prev and new_next. Panics if new_prev and new_next are not adjacent.
-    void enqueue(Slab* new_prev, Slab* new_next);
-
-    // Dequeues this slab. After dequeueing, this slab can't be found in the list of slabs anymore, but this
-    // slab keeps its next and prev pointers.
-    void dequeue();
-
-    inline void* alloc();
-
-    inline void free(void* ptr);
-};
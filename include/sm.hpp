@@ -23,18 +23,72 @@
 #pragma once
 
 #include "ec.hpp"
+#include "kp.hpp"
 
 class Sm : public Typed_kobject<Kobject::Type::SM>, public Refcount, public Queue<Ec>
 {
 private:
     mword counter;
 
+    // Semaphores can keep their counter in a KP that is shared with user space. User space then performs
+    // uncontended up and down operations with atomic instructions on this counter and only enters the kernel
+    // to block or to wake up a blocked EC:
+    //
+    // - A positive value is the number of available resources.
+    // - Otherwise, the negated value is the number of ECs that are blocked or about to block.
+    //
+    // The kernel counter above then only counts wakeups that arrived before the EC they are meant for blocked.
+    Refptr<Kp> const kp;
+    int64* const user_counter;
+
+    // ECs that wait for this semaphore and others in Ec::sys_sm_wait_any.
+    Queue<Sm_waiter> waiters;
+
     static Slab_cache cache;
 
+    // Dequeue waiters until the EC of one of them claims the wakeup. Waiters that lose have been woken up by
+    // another semaphore. Returns the EC that claimed the wakeup or nullptr.
+    inline Ec* claim_waiter()
+    {
+        for (Sm_waiter* w; waiters.dequeue(w = waiters.head());) {
+            if (w->ec->claim_sm_wait_any(w))
+                return w->ec;
+        }
+
+        return nullptr;
+    }
+
+    // Wake up all ECs that wait for this semaphore in Ec::sys_sm_wait_any with BAD_CAP. They hold references
+    // to the semaphore until they have left all semaphores, so this cannot wait for the destructor.
+    inline void revoke_waiters()
+    {
+        for (Ec* ec;;) {
+            {
+                Lock_guard<Spinlock> guard(lock);
+
+                ec = claim_waiter();
+
+                if (!ec)
+                    return;
+
+                bool ok = ec->add_ref();
+                assert(ok);
+            }
+
+            ec->release(Ec::sys_sm_wait_any_revoked);
+
+            if (ec->del_rcu())
+                Rcu::call(ec);
+        }
+    }
+
     static void free(Rcu_elem* a)
     {
         Sm* sm = static_cast<Sm*>(a);
 
+        // The capability is gone and the grace period has passed, so no EC can start to wait anymore.
+        sm->revoke_waiters();
+
         if (sm->del_ref())
             delete sm;
         else {
@@ -52,7 +106,7 @@ public:
         PERM_ALL = PERM_UP | PERM_DOWN,
     };
 
-    Sm(Pd*, mword, mword = 0);
+    Sm(Pd*, mword, mword = 0, Kp* = nullptr, mword = 0);
     ~Sm()
     {
         while (!counter)
@@ -83,6 +137,51 @@ public:
         ec->block_sc();
     }
 
+    inline bool has_user_counter() const { return user_counter; }
+
+    // Take a resource without blocking. Returns false, if there is none.
+    inline bool try_dn()
+    {
+        Lock_guard<Spinlock> guard(lock);
+
+        if (!counter)
+            return false;
+
+        counter--;
+        return true;
+    }
+
+    // Queue an EC that waits for this semaphore and others. If there is a resource, the EC takes it instead
+    // and this function returns true.
+    inline bool enqueue_waiter(Sm_waiter* w)
+    {
+        Lock_guard<Spinlock> guard(lock);
+
+        if (counter and w->ec->claim_sm_wait_any(w)) {
+            counter--;
+            return true;
+        }
+
+        waiters.enqueue(w);
+        return false;
+    }
+
+    inline void dequeue_waiter(Sm_waiter* w)
+    {
+        Lock_guard<Spinlock> guard(lock);
+        waiters.dequeue(w);
+    }
+
+    // A down operation that the kernel performs on behalf of an EC. For semaphores with a user-space counter,
+    // this follows the same protocol as user space.
+    inline void dn_kernel(Ec* ec, bool block)
+    {
+        if (user_counter and Atomic::sub(*user_counter, int64{1}) >= 0)
+            return;
+
+        dn(false, ec, block);
+    }
+
     inline void up(void (*c)() = nullptr)
     {
         Ec* ec = nullptr;
@@ -91,16 +190,28 @@ public:
             if (ec)
                 Rcu::call(ec);
 
+            void (*cont)() = c;
+
             {
                 Lock_guard<Spinlock> guard(lock);
 
                 if (!Queue<Ec>::dequeue(ec = Queue<Ec>::head())) {
-                    counter++;
-                    return;
+                    ec = claim_waiter();
+
+                    if (!ec) {
+                        counter++;
+                        return;
+                    }
+
+                    // The EC keeps its own reference until it has left all semaphores after this wakeup. This
+                    // reference takes the place of the reference that ECs in the queue hold.
+                    bool ok = ec->add_ref();
+                    assert(ok);
+                    cont = Ec::sys_sm_wait_any_done;
                 }
             }
 
-            ec->release(c);
+            ec->release(cont);
 
         } while (EXPECT_FALSE(ec->del_rcu()));
     }
@@ -32,6 +32,7 @@
 class Space_mem
 {
     CPULOCAL_ACCESSOR(space_mem, tlb_shootdown);
+    CPULOCAL_REMOTE_ACCESSOR(space_mem, tlb_pending);
 
 public:
     Hpt hpt;
@@ -92,6 +93,21 @@ public:
     // Revoke specific rights from a region of memory.
     void revoke(Tlb_cleanup& cleanup, mword vaddr, mword ord, mword attr);
 
+    // Mark the host TLB as stale on all CPUs of this memory space.
+    //
+    // The pages recorded in the given cleanup object are remembered per CPU, so the TLB can be invalidated
+    // selectively instead of being flushed entirely. The actual invalidation must be triggered by the caller,
+    // e.g. via shootdown().
+    void mark_host_tlb_stale(Tlb_cleanup const& cleanup);
+
+    // Invalidate stale host TLB entries on the current CPU.
+    //
+    // Must only be called when this memory space is active on the current CPU.
+    void invalidate_stale_host_tlb();
+
+    // Forget about stale host TLB entries on the current CPU, because the caller flushes the TLB entirely.
+    void discard_stale_host_tlb();
+
     static void shootdown();
 
     void init(unsigned);
@@ -55,4 +55,8 @@ public:
     static void page_fault(mword, mword);
 
     static bool insert_root(Kobject*);
+
+    // Allocate the capability table pages for the given range of selectors up front, so inserting the
+    // capabilities does not have to find or allocate them one by one.
+    void populate(mword, mword);
 };
@@ -26,6 +26,7 @@
 
 #include "arch.hpp"
 #include "crd.hpp"
+#include "memory.hpp"
 #include "mtd.hpp"
 #include "qpd.hpp"
 #include "regs.hpp"
@@ -112,6 +113,52 @@ public:
     inline unsigned long pd() const { return ARG_2; }
 
     inline mword cnt() const { return ARG_3; }
+
+    inline bool has_user_counter() const { return flags() & 0x1; }
+
+    inline unsigned long kp() const { return ARG_4; }
+
+    inline mword offset() const { return ARG_5; }
+};
+
+class Sys_sm_wait_any : public Sys_regs
+{
+public:
+    inline unsigned long count() const { return ARG_1 >> ARG1_VALUE_SHIFT; }
+};
+
+class Sys_create_notification : public Sys_regs
+{
+public:
+    inline unsigned long sel() const { return ARG_1 >> ARG1_VALUE_SHIFT; }
+
+    inline unsigned long pd() const { return ARG_2; }
+};
+
+class Sys_create_bulk : public Sys_regs
+{
+public:
+    enum Object
+    {
+        SM = 0,
+        KP = 1,
+        NOTIFICATION = 2,
+    };
+
+    static constexpr mword max_count{512};
+
+    inline unsigned long sel() const { return ARG_1 >> ARG1_VALUE_SHIFT; }
+
+    inline unsigned long pd() const { return ARG_2; }
+
+    inline mword type() const { return ARG_3; }
+
+    inline mword count() const { return ARG_4; }
+
+    // The initial count of semaphores.
+    inline mword param() const { return ARG_5; }
+
+    inline void set_created(mword n) { ARG_2 = n; }
 };
 
 class Sys_create_kp : public Sys_regs
@@ -194,6 +241,53 @@ public:
     inline Crd dst_crd() const { return Crd{ARG_5}; }
 };
 
+class Sys_delegate_batch : public Sys_regs
+{
+public:
+    // A single operation as it is stored in the message registers of the UTCB.
+    struct Entry {
+        mword crd;       // Source CRD for delegations, the CRD to revoke for revocations.
+        mword meta;      // Delegate flags for delegations, ignored for revocations.
+        mword dst_crd;   // Destination CRD for delegations, ignored for revocations.
+        mword op_status; // The operation on input, the resulting status on output.
+    };
+
+    enum Op
+    {
+        DELEGATE = 0,
+        REVOKE = 1,
+    };
+
+    static Op op(Entry const& e) { return static_cast<Op>(e.op_status & 0x3); }
+
+    // Whether a revocation also removes the capabilities from the destination PD itself.
+    static bool revoke_self(Entry const& e) { return e.op_status & 0x4; }
+
+    inline mword src_pd() const { return ARG_1 >> ARG1_VALUE_SHIFT; }
+
+    inline mword dst_pd() const { return ARG_2; }
+
+    inline mword count() const { return ARG_3; }
+};
+
+class Sys_multicall : public Sys_regs
+{
+public:
+    // A single system call as it is stored in the KP. The words hold the ARG1 to ARG5 registers on input and
+    // the OUT1 to OUT5 registers on output.
+    struct Entry {
+        mword arg[5];
+    };
+
+    static constexpr mword max_count{PAGE_SIZE / sizeof(Entry)};
+
+    inline mword kp() const { return ARG_1 >> ARG1_VALUE_SHIFT; }
+
+    inline mword count() const { return ARG_2; }
+
+    inline void set_completed(mword n) { ARG_2 = n; }
+};
+
 class Sys_pd_ctrl_msr_access : public Sys_regs
 {
 public:
@@ -262,6 +356,24 @@ public:
     inline uint64 time() const { return static_cast<uint64>(ARG_2) << 32 | ARG_3; }
 };
 
+class Sys_notification_ctrl : public Sys_regs
+{
+public:
+    enum Notification_operation
+    {
+        SIGNAL = 0,
+        WAIT = 1,
+    };
+
+    inline unsigned long notification() const { return ARG_1 >> ARG1_VALUE_SHIFT; }
+
+    inline unsigned op() const { return flags() & 0x1; }
+
+    inline uint64 bits() const { return ARG_2; }
+
+    inline void set_bits(uint64 bits) { ARG_2 = bits; }
+};
+
 class Sys_kp_ctrl : public Sys_regs
 {
 public:
@@ -281,6 +393,8 @@ class Sys_kp_ctrl_map : public Sys_regs
 public:
     inline mword kp() const { return ARG_1 >> ARG1_VALUE_SHIFT; }
 
+    inline bool read_only() const { return flags() & 0x4; }
+
     inline mword dst_pd() const { return ARG_2; }
 
     inline mword dst_addr() const { return ARG_3; }
@@ -299,6 +413,7 @@ public:
     {
         SUSPEND = 0,
         UPDATE_MICROCODE = 1,
+        PAGE_CACHE_STATS = 2,
     };
 
     inline ctrl_op op() const { return static_cast<ctrl_op>(flags() & 0x3); }
@@ -332,6 +447,13 @@ public:
     inline mword update_address() const { return static_cast<mword>(ARG_2); }
 };
 
+class Sys_machine_ctrl_page_cache_stats : public Sys_machine_ctrl
+{
+public:
+    inline unsigned long cpu() const { return ARG_1 >> ARG1_VALUE_SHIFT; }
+    inline unsigned long kp() const { return ARG_2; }
+};
+
 class Sys_vcpu_ctrl : public Sys_regs
 {
 public:
@@ -339,9 +461,14 @@ public:
     {
         RUN = 0,
         POKE = 1,
+        EXIT_MTD = 2,
+        LOAD_STATE = 3,
+        CPUID_TABLE = 4,
+        MSR_TABLE = 5,
+        EXIT_STATS = 6,
     };
 
-    inline ctrl_op op() const { return static_cast<ctrl_op>(flags() & 0x3u); }
+    inline ctrl_op op() const { return static_cast<ctrl_op>(flags()); }
 };
 
 class Sys_vcpu_ctrl_run : public Sys_vcpu_ctrl
@@ -356,3 +483,54 @@ class Sys_vcpu_ctrl_poke : public Sys_vcpu_ctrl
 public:
     inline unsigned long sel() const { return ARG_1 >> ARG1_VALUE_SHIFT; }
 };
+
+class Sys_vcpu_ctrl_exit_mtd : public Sys_vcpu_ctrl
+{
+public:
+    inline unsigned long sel() const { return ARG_1 >> ARG1_VALUE_SHIFT; }
+    inline mword exit_reason() const { return ARG_2; }
+    inline Mtd mtd() const { return Mtd(ARG_3); }
+};
+
+class Sys_vcpu_ctrl_load_state : public Sys_vcpu_ctrl
+{
+public:
+    inline unsigned long sel() const { return ARG_1 >> ARG1_VALUE_SHIFT; }
+    inline Mtd mtd() const { return Mtd(ARG_2); }
+};
+
+class Sys_vcpu_ctrl_cpuid_table : public Sys_vcpu_ctrl
+{
+public:
+    enum
+    {
+        REMOVE = 1ul << 0,
+    };
+
+    inline unsigned long sel() const { return ARG_1 >> ARG1_VALUE_SHIFT; }
+    inline unsigned long kp() const { return ARG_2; }
+    inline bool remove() const { return ARG_3 & REMOVE; }
+};
+
+class Sys_vcpu_ctrl_msr_table : public Sys_vcpu_ctrl
+{
+public:
+    enum
+    {
+        REMOVE = 1ul << 0,
+        NOTIFICATION = 1ul << 1,
+    };
+
+    inline unsigned long sel() const { return ARG_1 >> ARG1_VALUE_SHIFT; }
+    inline unsigned long kp() const { return ARG_2; }
+    inline unsigned long notification() const { return ARG_3; }
+    inline bool remove() const { return ARG_4 & REMOVE; }
+    inline bool has_notification() const { return ARG_4 & NOTIFICATION; }
+};
+
+class Sys_vcpu_ctrl_exit_stats : public Sys_vcpu_ctrl
+{
+public:
+    inline unsigned long sel() const { return ARG_1 >> ARG1_VALUE_SHIFT; }
+    inline unsigned long kp() const { return ARG_2; }
+};
@@ -20,53 +20,72 @@
 #include "assert.hpp"
 #include "buddy.hpp"
 #include "compiler.hpp"
+#include "tlb_ranges.hpp"
 #include "types.hpp"
 #include "util.hpp"
 
 // Deferred cleanup of page table structures and TLB flush tracking.
 //
 // This class does not implement the TLB flushing logic itself as this is
-// specific to the page table in question.
+// specific to the page table in question. Besides whether a flush is needed at
+// all, it remembers which pages were affected, so the flush can be limited to
+// these pages.
 class Tlb_cleanup
 {
-    bool tlb_flush_{false};
+    Tlb_ranges ranges_;
 
 public:
     using pointer = mword*;
 
+private:
+    // Page table pages that are freed once the TLB flush has happened.
+    //
+    // The pages are chained via their first entry. Page addresses are page
+    // aligned, so the link looks like a non-present entry to a hardware page
+    // walker that still uses a stale paging-structure cache entry to reach
+    // the page. This holds for both HPT and EPT entries.
+    pointer free_list_{nullptr};
+
+public:
     // Returns true, if a TLB flush is scheduled.
-    WARN_UNUSED_RESULT bool need_tlb_flush() const { return tlb_flush_; }
+    WARN_UNUSED_RESULT bool need_tlb_flush() const { return not ranges_.empty(); }
+
+    // Returns the pages whose TLB entries need to be invalidated.
+    Tlb_ranges const& ranges() const { return ranges_; }
 
     // Discard a scheduled TLB flush.
     //
     // This should be done with care as wrong usage will end up in TLB
     // invalidation bugs.
-    void ignore_tlb_flush() { tlb_flush_ = false; }
+    void ignore_tlb_flush() { ranges_.clear(); }
+
+    // Schedule a full TLB flush.
+    void flush_tlb_later() { ranges_.add_full(); }
 
-    // Schedule a TLB flush.
-    void flush_tlb_later() { tlb_flush_ = true; }
+    // Schedule the invalidation of the TLB entries of the page table leaf
+    // entry at the given virtual address.
+    void flush_tlb_later(mword vaddr) { ranges_.add(vaddr); }
 
     // Free all pages that were marked for deferred reclamation immediately.
     void free_pages_now()
     {
-        assert(not tlb_flush_);
+        assert(not need_tlb_flush());
 
-        // Not implemented yet.
+        if (free_list_) {
+            Buddy::allocator.free_chain(reinterpret_cast<mword>(free_list_));
+            free_list_ = nullptr;
+        }
     }
 
     // Mark a page as to-be-freed after the next TLB flush.
     //
-    // It is safe to be read from and written to until the TLB flush
-    // actually happens.
+    // It is safe to be read from until the TLB flush actually happens.
     void free_later(pointer page)
     {
-        tlb_flush_ = true;
+        ranges_.add_full();
 
-        // This is not correct, because we need to defer freeing this page
-        // until the TLB flush has happened. As the broken behavior was
-        // already in the kernel, continue to live in the danger zone until
-        // we fix this issue for good.
-        Buddy::allocator.free(reinterpret_cast<mword>(page));
+        *page = reinterpret_cast<mword>(free_list_);
+        free_list_ = page;
     }
 
     // Merge two Tlb_cleanup objects.
@@ -76,13 +95,26 @@ public:
     // deferred action pending.
     template <typename CLEANUP> void merge(CLEANUP&& rhs)
     {
-        tlb_flush_ |= rhs.tlb_flush_;
+        ranges_.merge(rhs.ranges_);
         rhs.ignore_tlb_flush();
+
+        // Append our free list to the one of rhs. The merged list is
+        // usually short, because page tables are rarely freed.
+        if (rhs.free_list_) {
+            pointer last{rhs.free_list_};
+            while (*last) {
+                last = reinterpret_cast<pointer>(*last);
+            }
+
+            *last = reinterpret_cast<mword>(free_list_);
+            free_list_ = rhs.free_list_;
+            rhs.free_list_ = nullptr;
+        }
     }
 
     Tlb_cleanup& operator=(Tlb_cleanup&& rhs)
     {
-        assert(not tlb_flush_);
+        assert(not need_tlb_flush());
 
         merge(rhs);
         return *this;
@@ -94,16 +126,24 @@ public:
     Tlb_cleanup(Tlb_cleanup const& rhs) = delete;
 
     Tlb_cleanup() = default;
-    explicit Tlb_cleanup(bool tlb_flush) : tlb_flush_{tlb_flush} {}
+    explicit Tlb_cleanup(bool tlb_flush)
+    {
+        if (tlb_flush) {
+            flush_tlb_later();
+        }
+    }
 
     // A named convenience constructor for readable code.
     static Tlb_cleanup tlb_flush(bool tlb_flush) { return Tlb_cleanup{tlb_flush}; }
 
+    // Frees all pages that were marked for deferred reclamation.
+    //
+    // The owner must have flushed the TLB and called ignore_tlb_flush()
+    // before, if there are any such pages.
     ~Tlb_cleanup()
     {
-        // Once we fully implement this class, at destruction time there
-        // should be no TLB flush pending and all pages can be freed.
-        //
-        // assert (not tlb_flush_);
+        if (free_list_) {
+            free_pages_now();
+        }
     }
 };
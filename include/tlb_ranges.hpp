@@ -0,0 +1,108 @@
+/*
+ * Selective TLB invalidation tracking
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "spinlock.hpp"
+#include "types.hpp"
+
+// A small set of pages whose TLB entries have to be invalidated.
+//
+// Each entry is the virtual base address of a page table leaf entry that was changed or removed. A single
+// INVLPG on this address invalidates all TLB entries derived from the leaf, regardless of the page size (see
+// Intel SDM Vol. 3 Chap. 4.10.4.1 "Operations that Invalidate TLBs and Paging-Structure Caches"). It also
+// invalidates all paging-structure caches of the current PCID.
+//
+// If more pages are added than fit into the set, it degrades into a full TLB flush. The same happens when
+// the caller requests a full flush explicitly.
+class Tlb_ranges
+{
+public:
+    // The number of INVLPGs above which a full TLB flush is cheaper than invalidating individual pages.
+    static constexpr size_t MAX_PAGES{16};
+
+private:
+    mword pages_[MAX_PAGES];
+    size_t count_{0};
+    bool full_{false};
+
+public:
+    // Returns true, if there is nothing to invalidate.
+    bool empty() const { return count_ == 0 and not full_; }
+
+    // Returns true, if the whole TLB needs to be flushed.
+    bool full() const { return full_; }
+
+    size_t count() const { return count_; }
+
+    mword const* begin() const { return pages_; }
+    mword const* end() const { return pages_ + count_; }
+
+    // Request invalidation of the page at the given virtual address.
+    void add(mword vaddr)
+    {
+        if (full_) {
+            return;
+        }
+
+        if (count_ == MAX_PAGES) {
+            add_full();
+            return;
+        }
+
+        pages_[count_++] = vaddr;
+    }
+
+    // Request a full TLB flush.
+    void add_full()
+    {
+        full_ = true;
+        count_ = 0;
+    }
+
+    void merge(Tlb_ranges const& rhs)
+    {
+        if (rhs.full_) {
+            add_full();
+            return;
+        }
+
+        for (mword vaddr : rhs) {
+            add(vaddr);
+        }
+    }
+
+    void clear()
+    {
+        full_ = false;
+        count_ = 0;
+    }
+};
+
+// Pending host TLB invalidations for a single CPU.
+//
+// Other CPUs record which pages of which address space have to be invalidated, before they mark the address
+// space as stale on this CPU. The CPU collects them when it handles its stale TLB. Only a single address
+// space is tracked: invalidations for any other address space degrade to a full flush.
+struct Tlb_pending {
+    Spinlock lock;
+
+    // The address space the pages belong to. This is only used as a tag and never dereferenced.
+    void const* space{nullptr};
+
+    Tlb_ranges ranges;
+};
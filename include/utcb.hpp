@@ -27,6 +27,7 @@
 #include "buddy.hpp"
 #include "crd.hpp"
 #include "math.hpp"
+#include "vmcs_cache.hpp"
 
 class Cpu_regs;
 
@@ -133,8 +134,8 @@ public:
     WARN_UNUSED_RESULT bool load_exc(Cpu_regs*);
     WARN_UNUSED_RESULT bool save_exc(Cpu_regs*);
 
-    void load_vmx(Cpu_regs*);
-    void save_vmx(Cpu_regs* regs, const bool passthrough_vcpu);
+    void load_vmx(Cpu_regs*, Vmcs_cache& cache);
+    void save_vmx(Cpu_regs* regs, Vmcs_cache& cache, const bool passthrough_vcpu);
 
     inline mword ucnt() const { return static_cast<uint16>(items); }
     inline mword tcnt() const { return static_cast<uint16>(items >> 16); }
@@ -144,6 +145,9 @@ public:
 
     inline mword& mr(mword i) { return (&data_begin)[i]; }
 
+    // The number of message registers that fit into the UTCB.
+    static inline mword mr_count() { return words; }
+
     NONNULL
     inline void save(Utcb* dst)
     {
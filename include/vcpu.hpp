@@ -17,9 +17,11 @@
 
 #pragma once
 
+#include "cpuid_table.hpp"
 #include "fpu.hpp"
 #include "kobject.hpp"
 #include "kp.hpp"
+#include "msr_table.hpp"
 #include "mtd.hpp"
 #include "optional.hpp"
 #include "pd.hpp"
@@ -28,10 +30,14 @@
 #include "slab.hpp"
 #include "unique_ptr.hpp"
 #include "utcb.hpp"
+#include "vcpu_stats.hpp"
+#include "vmcs_cache.hpp"
 #include "vlapic.hpp"
 #include "vmx.hpp"
 #include "vmx_msr_bitmap.hpp"
 
+class Notification;
+
 // A struct that is passed to the vCPU's constructor.
 struct Vcpu_init_config {
     Pd* owner_pd;
@@ -84,6 +90,40 @@ private:
     const Refptr<Kp> kp_vlapic_page;
     const Refptr<Kp> kp_fpu_state;
 
+    // The CPUID results the kernel answers CPUID exits with. See Cpuid_table.
+    Refptr<Kp> kp_cpuid_table;
+
+    // The MSRs the kernel emulates and the notification that is signaled on writes to them. See Msr_table.
+    Refptr<Kp> kp_msr_table;
+    Refptr<Notification> msr_notification;
+
+    // The KP the exit statistics are written to. See Vcpu_exit_stats.
+    Refptr<Kp> kp_exit_stats;
+
+    // The TSC value when the time accounting last switched between the guest, the kernel and the VMM.
+    uint64 tsc_mark{0};
+
+    // True if the vCPU is waiting for the VMM to run it again. Only used for time accounting.
+    bool in_vmm{true};
+
+    // Returns the exit statistics or nullptr if the VMM did not ask for them.
+    Vcpu_exit_stats* exit_stats()
+    {
+        Kp* kp{kp_exit_stats.get()};
+        return kp ? static_cast<Vcpu_exit_stats*>(kp->data_page()) : nullptr;
+    }
+
+    // Increments the given exit statistics counter.
+    void count(uint64 Vcpu_exit_stats::*counter)
+    {
+        if (Vcpu_exit_stats* stats{exit_stats()}) {
+            stats->*counter += 1;
+        }
+    }
+
+    // Adds the TSC ticks since the last call to the given exit statistics counter.
+    void account_tsc(uint64 Vcpu_exit_stats::*counter);
+
     Utcb* utcb() { return reinterpret_cast<Utcb*>(kp_vcpu_state.get()->data_page()); }
 
     const unsigned cpu_id; // The ID of the CPU this vCPU is running on.
@@ -91,6 +131,10 @@ private:
     Unique_ptr<Msr_area> guest_msr_area;
     Unique_ptr<Vmx_msr_bitmap> msr_bitmap;
 
+    // Shadows the VMCS fields that are transferred between the VMCS and the vCPU state page. See
+    // Generic_vmcs_cache for when the cached values are valid.
+    Vmcs_cache vmcs_cache;
+
     // The VMCS does not contain general-purpose register content, so we have to save them separately.
     //
     // TODO: When we decouple the vCPU-State and the UTCB in the future, the VM exit path can store the
@@ -124,6 +168,12 @@ private:
     // guarded by Vcpu::owner.
     bool has_entered{false};
 
+    // True if the VMCS holds the guest state of the VM exit that Vcpu::return_to_vmm reported last.
+    //
+    // Vcpu::return_to_vmm sets this flag when it returns after we entered the vCPU and Vcpu::run clears it. Like
+    // has_entered, it is guarded by Vcpu::owner.
+    bool has_exit_state{false};
+
     // We force-enabled MTF for the vCPU, because we have a poke event pending.
     bool has_pending_mtf_trap{false};
 
@@ -140,6 +190,12 @@ private:
     // this shadow instead. The VM exit path then has to use this value instead of the one inside the VMCS.
     Optional<uint32> exit_reason_shadow{};
 
+    // The state that is transferred to the vCPU state page for each basic exit reason. The VMM can restrict
+    // this to the state it needs to handle the exit and fetch the rest with Vcpu::load_state.
+    //
+    // This array must be accessed using atomic ops, because the VMM may update it while the vCPU runs.
+    uint32 exit_mtd[NUM_VMI];
+
     // Returns the current exit reason. See comment above in exit_reason_shadow for an explanation why this
     // exists.
     uint32 exit_reason()
@@ -152,6 +208,9 @@ private:
         return exit_reason_shadow.value();
     }
 
+    // Transfers the given state from the VMCS into the vCPU state page.
+    void transfer_state(Mtd mtd);
+
     // Transfers the VMCS contents into the vCPU state page and returns to the VMM with the given status.
     [[noreturn]] void return_to_vmm(Sys_regs::Status status);
 
@@ -159,6 +218,20 @@ private:
     // passes control flow to Ec::run_vcpu.
     [[noreturn]] void continue_running();
 
+    // Answers a CPUID exit from the CPUID table. Returns false if the VMM has to handle the exit.
+    bool emulate_cpuid();
+
+    // Handle RDMSR and WRMSR exits using the MSR table. Return false if the VMM has to handle the exit.
+    bool emulate_rdmsr();
+    bool emulate_wrmsr();
+
+    // Returns true if the guest expects a debug exception or the VMM expects a monitor trap flag exit after the
+    // current instruction. We never complete instructions in the kernel in this case.
+    bool is_single_stepping();
+
+    // Advances the guest instruction pointer past the instruction that caused the VM exit.
+    void skip_instruction();
+
     // Handles a VM exit due to an exception.
     [[noreturn]] inline void handle_exception();
 
@@ -201,7 +274,7 @@ public:
     static void init();
 
     explicit Vcpu(const Vcpu_init_config& init_cfg);
-    ~Vcpu() = default;
+    ~Vcpu();
 
     // Tries to set the current EC as the new owner. ECs are only allowed to modify the vCPUs state or to run
     // it after a successful call to this function. The owner of a vCPU has the duty to release it, the vCPU
@@ -215,6 +288,30 @@ public:
     // modifying its MTD bits!
     void mtd(Mtd mtd);
 
+    // Sets the state that is transferred to the vCPU state page on VM exits with the given basic exit reason.
+    // The exit reason must be smaller than NUM_VMI.
+    void set_exit_mtd(unsigned basic_exit_reason, Mtd mtd);
+
+    // Transfers the given state of the last VM exit into the vCPU state page. This allows the VMM to fetch
+    // state that was not transferred due to the exit MTD. An EC has to acquire this vCPU before loading its
+    // state!
+    //
+    // Returns false without touching the state page, if the vCPU did not return from a VM exit.
+    bool load_state(Mtd mtd);
+
+    // Sets the KP that holds the CPUID table of this vCPU or removes the table if the KP is a nullptr. An EC has
+    // to acquire this vCPU before setting the CPUID table!
+    void set_cpuid_table(Kp* kp);
+
+    // Sets the KP that holds the MSR table of this vCPU and the notification that is signaled on writes to
+    // MSRs in this table. Both may be a nullptr. Without a KP, there is no MSR table. An EC has to acquire this
+    // vCPU before setting the MSR table!
+    void set_msr_table(Kp* kp, Notification* notification);
+
+    // Sets the KP that the exit statistics of this vCPU are written to and clears it. An EC has to acquire this
+    // vCPU before setting the statistics page!
+    void set_exit_stats(Kp* kp);
+
     // Prepares this vCPU to be executed (e.g. transfers the modified vCPU state fields) and then enters this
     // vCPU. An EC has to acquire this vCPU before it is allowed to execute it.
     [[noreturn]] void run();
@@ -0,0 +1,52 @@
+/*
+ * vCPU Exit Statistics
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "config.hpp"
+#include "memory.hpp"
+#include "types.hpp"
+
+// The counters the kernel maintains for a vCPU in its statistics page.
+//
+// Only the kernel writes to this page and it never uses the values for anything else, so the VMM can read them
+// at any time. Counters are not updated atomically with respect to each other.
+struct Vcpu_exit_stats {
+    // VM exits per basic exit reason, including the exits that the kernel handled itself.
+    uint64 exits[NUM_VMI];
+
+    // TSC ticks spent in the guest, in the kernel on behalf of the vCPU, and in the VMM between returning from
+    // and calling vcpu_ctrl_run.
+    uint64 tsc_guest, tsc_kernel, tsc_vmm;
+
+    // Returns from vcpu_ctrl_run to the VMM.
+    uint64 vmm_returns;
+
+    // Pokes that requested the vCPU to return to the VMM.
+    uint64 pokes;
+
+    // Monitor trap flag exits the kernel caused to handle a poke, which are reported as poked exits.
+    uint64 mtf_poked_exits;
+
+    // Exits due to NMIs that were handled in the kernel and re-entered the guest.
+    uint64 nmi_reentries;
+
+    // Exits that were handled using the CPUID and MSR tables.
+    uint64 cpuid_in_kernel, rdmsr_in_kernel, wrmsr_in_kernel;
+};
+static_assert(sizeof(Vcpu_exit_stats) == NUM_VMI * 8 + 0x50, "vCPU exit statistics layout is part of the ABI.");
+static_assert(sizeof(Vcpu_exit_stats) <= PAGE_SIZE, "vCPU exit statistics must fit into a KP.");
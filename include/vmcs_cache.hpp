@@ -0,0 +1,216 @@
+/*
+ * VMCS Field Cache
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#pragma once
+
+#include "types.hpp"
+#include "vmx.hpp"
+
+/**
+ * A software shadow of frequently transferred VMCS fields.
+ *
+ * VMREAD and VMWRITE are expensive compared to memory accesses. When the VMM resumes a vCPU, it usually hands
+ * back most of the state it received on the VM exit unmodified. The cache remembers the values that were
+ * read or written since the last VM entry, so writing back an unchanged value does not touch the VMCS.
+ *
+ * Guest state fields are only valid until the guest runs again, because the guest can modify them without
+ * causing a VM exit. Control fields that neither the guest nor the processor modify stay valid across VM
+ * entries, so reading them after a VM exit does not touch the VMCS either.
+ *
+ * All accesses go to the VMCS that is current on this CPU. The owner of the cache has to make the matching
+ * VMCS current before using the cache.
+ *
+ * The VMCS accessor is a template parameter to be able to test this class.
+ */
+template <typename VMCS> class Generic_vmcs_cache
+{
+public:
+    enum Field : unsigned
+    {
+        // Guest state. The guest can modify these fields while it runs.
+        RSP,
+        RIP,
+        RFLAGS,
+        SEL_ES,
+        SEL_CS,
+        SEL_SS,
+        SEL_DS,
+        SEL_FS,
+        SEL_GS,
+        SEL_LDTR,
+        SEL_TR,
+        BASE_ES,
+        BASE_CS,
+        BASE_SS,
+        BASE_DS,
+        BASE_FS,
+        BASE_GS,
+        BASE_LDTR,
+        BASE_TR,
+        BASE_GDTR,
+        BASE_IDTR,
+        LIMIT_ES,
+        LIMIT_CS,
+        LIMIT_SS,
+        LIMIT_DS,
+        LIMIT_FS,
+        LIMIT_GS,
+        LIMIT_LDTR,
+        LIMIT_TR,
+        LIMIT_GDTR,
+        LIMIT_IDTR,
+        AR_ES,
+        AR_CS,
+        AR_SS,
+        AR_DS,
+        AR_FS,
+        AR_GS,
+        AR_LDTR,
+        AR_TR,
+        DR7,
+        SYSENTER_CS,
+        SYSENTER_ESP,
+        SYSENTER_EIP,
+        INTR_STATE,
+        ACTV_STATE,
+        PAT,
+        PDPTE0,
+        PDPTE1,
+        PDPTE2,
+        PDPTE3,
+        INTR_STS,
+
+        // Control fields. Only software modifies these fields.
+        FIRST_CONTROL_FIELD,
+        TSC_OFFSET = FIRST_CONTROL_FIELD,
+        TPR_THRESHOLD,
+        EOI_EXIT_BITMAP_0,
+        EOI_EXIT_BITMAP_1,
+        EOI_EXIT_BITMAP_2,
+        EOI_EXIT_BITMAP_3,
+        EXI_MSR_ST_ADDR,
+
+        FIELD_COUNT,
+    };
+
+    static_assert(FIELD_COUNT <= 64, "The valid mask cannot hold all fields");
+
+    // Returns the value of a field and only reads the VMCS if the field is not cached.
+    mword read(Field f)
+    {
+        if (not is_valid(f)) {
+            value[f] = VMCS::read(encoding(f));
+            valid |= bit(f);
+        }
+
+        return value[f];
+    }
+
+    // Sets a field to a new value and only writes the VMCS if the value differs from the cached value.
+    void write(Field f, mword val)
+    {
+        if (is_valid(f) and value[f] == val) {
+            return;
+        }
+
+        VMCS::write(encoding(f), val);
+        value[f] = val;
+        valid |= bit(f);
+    }
+
+    // Forgets all guest state fields. This has to be called whenever the guest had the chance to run.
+    void invalidate_guest_state() { valid &= ~(bit(FIRST_CONTROL_FIELD) - 1); }
+
+    // Forgets all fields. This has to be called whenever the VMCS is modified without using this cache.
+    void invalidate() { valid = 0; }
+
+    bool is_valid(Field f) const { return valid & bit(f); }
+
+private:
+    static constexpr uint64 bit(Field f) { return static_cast<uint64>(1) << f; }
+
+    static constexpr typename VMCS::Encoding encoding(Field f)
+    {
+        constexpr typename VMCS::Encoding encodings[FIELD_COUNT]{
+            VMCS::GUEST_RSP,
+            VMCS::GUEST_RIP,
+            VMCS::GUEST_RFLAGS,
+            VMCS::GUEST_SEL_ES,
+            VMCS::GUEST_SEL_CS,
+            VMCS::GUEST_SEL_SS,
+            VMCS::GUEST_SEL_DS,
+            VMCS::GUEST_SEL_FS,
+            VMCS::GUEST_SEL_GS,
+            VMCS::GUEST_SEL_LDTR,
+            VMCS::GUEST_SEL_TR,
+            VMCS::GUEST_BASE_ES,
+            VMCS::GUEST_BASE_CS,
+            VMCS::GUEST_BASE_SS,
+            VMCS::GUEST_BASE_DS,
+            VMCS::GUEST_BASE_FS,
+            VMCS::GUEST_BASE_GS,
+            VMCS::GUEST_BASE_LDTR,
+            VMCS::GUEST_BASE_TR,
+            VMCS::GUEST_BASE_GDTR,
+            VMCS::GUEST_BASE_IDTR,
+            VMCS::GUEST_LIMIT_ES,
+            VMCS::GUEST_LIMIT_CS,
+            VMCS::GUEST_LIMIT_SS,
+            VMCS::GUEST_LIMIT_DS,
+            VMCS::GUEST_LIMIT_FS,
+            VMCS::GUEST_LIMIT_GS,
+            VMCS::GUEST_LIMIT_LDTR,
+            VMCS::GUEST_LIMIT_TR,
+            VMCS::GUEST_LIMIT_GDTR,
+            VMCS::GUEST_LIMIT_IDTR,
+            VMCS::GUEST_AR_ES,
+            VMCS::GUEST_AR_CS,
+            VMCS::GUEST_AR_SS,
+            VMCS::GUEST_AR_DS,
+            VMCS::GUEST_AR_FS,
+            VMCS::GUEST_AR_GS,
+            VMCS::GUEST_AR_LDTR,
+            VMCS::GUEST_AR_TR,
+            VMCS::GUEST_DR7,
+            VMCS::GUEST_SYSENTER_CS,
+            VMCS::GUEST_SYSENTER_ESP,
+            VMCS::GUEST_SYSENTER_EIP,
+            VMCS::GUEST_INTR_STATE,
+            VMCS::GUEST_ACTV_STATE,
+            VMCS::GUEST_PAT,
+            VMCS::GUEST_PDPTE0,
+            VMCS::GUEST_PDPTE1,
+            VMCS::GUEST_PDPTE2,
+            VMCS::GUEST_PDPTE3,
+            VMCS::GUEST_INTR_STS,
+            VMCS::TSC_OFFSET,
+            VMCS::TPR_THRESHOLD,
+            VMCS::EOI_EXIT_BITMAP_0,
+            VMCS::EOI_EXIT_BITMAP_1,
+            VMCS::EOI_EXIT_BITMAP_2,
+            VMCS::EOI_EXIT_BITMAP_3,
+            VMCS::EXI_MSR_ST_ADDR,
+        };
+
+        return encodings[f];
+    }
+
+    uint64 valid{0};
+    mword value[FIELD_COUNT];
+};
+
+using Vmcs_cache = Generic_vmcs_cache<Vmcs>;
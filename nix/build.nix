@@ -8,7 +8,9 @@
   buildType ? "Debug",
   # Specify a kernel heap size in MiB. This overrides the default and
   # is advisable for more sophisticated workloads.
-  heapSizeMiB ? null
+  heapSizeMiB ? null,
+  # Build the hypercall and IPC benchmarks for test/integration/qemu-boot.
+  enableBenchmarks ? false
 }:
 
 let
@@ -29,7 +31,8 @@ stdenv.mkDerivation {
 
   cmakeBuildType = buildType;
   cmakeFlags = [ "-DENABLE_ELF_SEGMENT_CHECKS:bool=ON" ]
-               ++ lib.optional (heapSizeMiB != null) "-DHEAP_SIZE_MB=${toString heapSizeMiB}";
+               ++ lib.optional (heapSizeMiB != null) "-DHEAP_SIZE_MB=${toString heapSizeMiB}"
+               ++ lib.optional enableBenchmarks "-DENABLE_BENCHMARKS:bool=ON";
 
   hardeningDisable = [ "all" ];
   enableParallelBuilding = true;
@@ -94,11 +94,17 @@ let
 
   default-release = hedronBuildSet.gcc10-release;
   default-debug = hedronBuildSet.gcc10-debug;
+
+  # The benchmarks are not part of the default builds. Build them once, so they don't bitrot.
+  default-benchmarks = pkgs.callPackage ./build.nix {
+    buildType = "Release";
+    enableBenchmarks = true;
+  };
 in
 {
   hedron = {
     builds = {
-      inherit default-release default-debug;
+      inherit default-release default-debug default-benchmarks;
     } // hedronBuildSet;
 
     stylecheck = pkgs.callPackage ./stylecheck.nix { };
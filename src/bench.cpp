@@ -0,0 +1,189 @@
+/*
+ * Benchmarks
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+// This file is only built with ENABLE_BENCHMARKS. The benchmarks replace the roottask and are meant for
+// test/integration/qemu-boot, not for production systems.
+
+#include "ec.hpp"
+#include "cmdline.hpp"
+#include "pt.hpp"
+#include "stdio.hpp"
+#include "utcb.hpp"
+#include "x86.hpp"
+
+// Map the given user code of a benchmark into the current PD and return its address.
+static mword map_benchmark_code(uint8 const* code, size_t size)
+{
+    // The HIP and the UTCB of the root EC live at the top of the address space.
+    static constexpr mword code_addr{PAGE_SIZE};
+
+    assert(size <= PAGE_SIZE);
+
+    void* const page{Buddy::allocator.alloc(0, Buddy::FILL_0)};
+    memcpy(page, code, size);
+
+    // This PD only ever runs the benchmark, so we don't bother with the mapping database.
+    {
+        Tlb_cleanup cleanup{Pd::current()->Space_mem::insert(code_addr, 0, Hpt::PTE_U | Hpt::PTE_P,
+                                                             Buddy::ptr_to_phys(page))};
+
+        // The PD is not used yet.
+        cleanup.ignore_tlb_flush();
+    }
+
+    return code_addr;
+}
+
+void Ec::root_invoke_syscall_bench()
+{
+    // 1: mov $0xff, %edi
+    //    syscall
+    //    jmp 1b
+    static constexpr uint8 hypercall_loop[]{0xbf, 0xff, 0x00, 0x00, 0x00, 0x0f, 0x05, 0xeb, 0xf7};
+
+    current()->regs.set_ip(map_benchmark_code(hypercall_loop, sizeof(hypercall_loop)));
+
+    trace(0, "Running hypercall benchmark (%s)", Cmdline::nosysret ? "IRET" : "SYSRET");
+
+    ret_user_sysexit();
+}
+
+void Ec::sample_syscall_bench()
+{
+    // The first round trips warm up caches and TLBs and are not counted.
+    static constexpr unsigned WARMUP{1000};
+    static constexpr unsigned SAMPLES{100000};
+
+    static unsigned round_trips;
+    static uint64 start_tsc;
+
+    uint64 const now{rdtsc()};
+
+    if (round_trips++ == WARMUP) {
+        start_tsc = now;
+    } else if (round_trips == WARMUP + SAMPLES + 1) {
+        trace(0, "Hypercall round trip: %llu cycles (%s)", (now - start_tsc) / SAMPLES,
+              Cmdline::nosysret ? "IRET" : "SYSRET");
+        die("Hypercall benchmark done");
+    }
+}
+
+// The IPC path that the IPC benchmark measures.
+static char const* ipc_bench_mode()
+{
+    if (Cmdline::ipcremote) {
+        return "cross-CPU";
+    }
+
+    return Cmdline::noipcfast ? "slow path" : "fast path";
+}
+
+void Ec::root_invoke_ipc_bench()
+{
+    static constexpr mword caller_utcb{USER_ADDR - 2 * PAGE_SIZE};
+    static constexpr mword callee_utcb{USER_ADDR - 3 * PAGE_SIZE};
+    static constexpr mword callee_sel{NUM_EXC + 3};
+    static constexpr mword portal_sel{NUM_EXC + 4};
+    static constexpr mword callee_entry{0x3b};
+
+    static_assert(caller_utcb == 0x7fffffffd000 and callee_utcb == 0x7fffffffc000 and portal_sel == 0x24,
+                  "The benchmark code below hardcodes these values");
+
+    // The caller puts its TSC into the first message word and calls the callee. The callee adds its own TSC
+    // as the second word and replies. Back in the caller, the third word receives the TSC after the call,
+    // and an invalid hypercall lets the kernel account for the result.
+    //
+    // caller:    movabs $0x7fffffffd000, %rbx
+    //         1: movq $1, (%rbx)
+    //            rdtsc
+    //            shl $32, %rdx
+    //            or %rdx, %rax
+    //            mov %rax, 32(%rbx)
+    //            mov $0x24000, %edi
+    //            syscall
+    //            rdtsc
+    //            shl $32, %rdx
+    //            or %rdx, %rax
+    //            mov %rax, 48(%rbx)
+    //            mov $0xff, %edi
+    //            syscall
+    //            jmp 1b
+    //
+    // callee:    rdtsc
+    //            movabs $0x7fffffffc000, %rbx
+    //            shl $32, %rdx
+    //            or %rdx, %rax
+    //            mov %rax, 40(%rbx)
+    //            movq $2, (%rbx)
+    //            mov $1, %edi
+    //            syscall
+    static constexpr uint8 ipc_loop[]{
+        0x48, 0xbb, 0x00, 0xd0, 0xff, 0xff, 0xff, 0x7f, 0x00, 0x00, 0x48, 0xc7, 0x03, 0x01, 0x00, 0x00,
+        0x00, 0x0f, 0x31, 0x48, 0xc1, 0xe2, 0x20, 0x48, 0x09, 0xd0, 0x48, 0x89, 0x43, 0x20, 0xbf, 0x00,
+        0x40, 0x02, 0x00, 0x0f, 0x05, 0x0f, 0x31, 0x48, 0xc1, 0xe2, 0x20, 0x48, 0x09, 0xd0, 0x48, 0x89,
+        0x43, 0x30, 0xbf, 0xff, 0x00, 0x00, 0x00, 0x0f, 0x05, 0xeb, 0xcf, 0x0f, 0x31, 0x48, 0xbb, 0x00,
+        0xc0, 0xff, 0xff, 0xff, 0x7f, 0x00, 0x00, 0x48, 0xc1, 0xe2, 0x20, 0x48, 0x09, 0xd0, 0x48, 0x89,
+        0x43, 0x28, 0x48, 0xc7, 0x03, 0x02, 0x00, 0x00, 0x00, 0xbf, 0x01, 0x00, 0x00, 0x00, 0x0f, 0x05,
+    };
+
+    mword const code{map_benchmark_code(ipc_loop, sizeof(ipc_loop))};
+
+    // Cross-CPU calls go to the next CPU.
+    unsigned const callee_cpu{Cmdline::ipcremote ? (Cpu::id() + 1) % Cpu::online : Cpu::id()};
+
+    if (Cmdline::ipcremote and callee_cpu == Cpu::id()) {
+        die("The cross-CPU IPC benchmark needs a second CPU");
+    }
+
+    Pd* const pd{Pd::current()};
+    Ec* const callee{new Ec(pd, callee_sel, pd, nullptr, callee_cpu, 0, callee_utcb, 0, 0)};
+
+    Space_obj::insert_root(callee);
+    Space_obj::insert_root(new Pt(pd, portal_sel, callee, Mtd(0), code + callee_entry));
+
+    current()->regs.set_ip(code);
+
+    trace(0, "Running IPC benchmark (%s)", ipc_bench_mode());
+
+    ret_user_sysexit();
+}
+
+void Ec::sample_ipc_bench()
+{
+    // The first calls warm up caches and TLBs and are not counted.
+    static constexpr unsigned WARMUP{1000};
+    static constexpr unsigned SAMPLES{100000};
+
+    static unsigned calls;
+    static uint64 one_way_sum, round_trip_sum;
+
+    // See root_invoke_ipc_bench for how the caller fills its UTCB.
+    Utcb* const utcb{current()->utcb.get()};
+
+    if (calls++ < WARMUP) {
+        return;
+    }
+
+    one_way_sum += utcb->mr(1) - utcb->mr(0);
+    round_trip_sum += utcb->mr(2) - utcb->mr(0);
+
+    if (calls == WARMUP + SAMPLES) {
+        trace(0, "IPC one way: %llu cycles, round trip: %llu cycles (%s)", one_way_sum / SAMPLES,
+              round_trip_sum / SAMPLES, ipc_bench_mode());
+        die("IPC benchmark done");
+    }
+}
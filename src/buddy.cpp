@@ -20,6 +20,7 @@
 
 #include "buddy.hpp"
 #include "assert.hpp"
+#include "cpulocal.hpp"
 #include "initprio.hpp"
 #include "lock_guard.hpp"
 #include "math.hpp"
@@ -76,6 +77,17 @@ void Buddy::fill(void* dst, Fill fill_mem, size_t size)
     }
 }
 
+static auto page_cache() -> decltype(Per_cpu::buddy_page_cache)& { return Cpulocal::get().buddy_page_cache; }
+
+static auto zeroed_page_cache() -> decltype(Per_cpu::buddy_zeroed_page_cache)&
+{
+    return Cpulocal::get().buddy_zeroed_page_cache;
+}
+
+// The allocator is used during early boot and while application processors set up their CPU-local memory.
+// Checking the GS base is cheap compared to the lock we avoid.
+bool Buddy::use_page_cache() { return Cpulocal::is_initialized(); }
+
 /*
  * Allocate physically contiguous memory region.
  * @param ord       Block order (2^ord pages)
@@ -83,9 +95,101 @@ void Buddy::fill(void* dst, Fill fill_mem, size_t size)
  * @return          Pointer to linear memory region
  */
 Alloc_result<void*> Buddy::try_alloc(unsigned short ord, Fill fill_mem)
+{
+    mword virt{0};
+
+    if (ord == 0 and use_page_cache()) {
+        auto const no_refill{[](mword*, size_t) -> size_t { return 0; }};
+
+        // Pages that were zeroed ahead of time spare us the memset below.
+        if (fill_mem == FILL_0) {
+            virt = zeroed_page_cache().alloc(no_refill);
+            if (virt != 0) {
+                return Ok(reinterpret_cast<void*>(virt));
+            }
+        }
+
+        virt = page_cache().alloc([this](mword* pages, size_t n) { return alloc_batch(pages, n); });
+
+        // Pre-zeroed pages are still free memory.
+        if (EXPECT_FALSE(virt == 0 and fill_mem != FILL_0)) {
+            virt = zeroed_page_cache().take(no_refill);
+        }
+    } else {
+        virt = alloc_or_drain(ord);
+    }
+
+    if (EXPECT_FALSE(virt == 0)) {
+        trace(TRACE_ERROR, "Failed allocating %u pages from %p", 1U << ord, __builtin_return_address(0));
+        return Err(Out_of_memory_error());
+    }
+
+    fill(reinterpret_cast<void*>(virt), fill_mem, 1ul << (ord + PAGE_BITS));
+
+    return Ok(reinterpret_cast<void*>(virt));
+}
+
+mword Buddy::alloc_or_drain(unsigned short ord)
+{
+    {
+        Lock_guard<Spinlock> guard(lock);
+
+        mword const virt{alloc_locked(ord)};
+        if (EXPECT_TRUE(virt != 0 or not use_page_cache())) {
+            return virt;
+        }
+    }
+
+    // The pages in the local caches might be just what is missing to form a larger block.
+    page_cache().drain_all([this](mword const* pages, size_t n) { free_batch(pages, n); });
+    zeroed_page_cache().drain_all([this](mword const* pages, size_t n) { free_batch(pages, n); });
+
+    Lock_guard<Spinlock> guard(lock);
+    return alloc_locked(ord);
+}
+
+size_t Buddy::alloc_batch(mword* pages, size_t n)
 {
     Lock_guard<Spinlock> guard(lock);
 
+    size_t i{0};
+    while (i < n and (pages[i] = alloc_locked(0)) != 0) {
+        i++;
+    }
+
+    return i;
+}
+
+bool Buddy::prezero_page()
+{
+    if (not use_page_cache() or zeroed_page_cache().full()) {
+        return false;
+    }
+
+    mword const virt{page_cache().take([this](mword* pages, size_t n) { return alloc_batch(pages, n); })};
+    if (virt == 0) {
+        return false;
+    }
+
+    fill(reinterpret_cast<void*>(virt), FILL_0, PAGE_SIZE);
+    zeroed_page_cache().free(virt, [this](mword const* pages, size_t n) { free_batch(pages, n); });
+
+    return true;
+}
+
+void Buddy::free_batch(mword const* pages, size_t n)
+{
+    Lock_guard<Spinlock> guard(lock);
+
+    for (size_t i{0}; i < n; i++) {
+        free_locked(pages[i]);
+    }
+}
+
+mword Buddy::alloc_locked(unsigned short ord)
+{
+    assert(lock.is_locked());
+
     for (unsigned short j = ord; j < order; j++) {
 
         if (head[j].next == head + j)
@@ -110,16 +214,13 @@ Alloc_result<void*> Buddy::try_alloc(unsigned short ord, Fill fill_mem)
         // Ensure corresponding physical block is order-aligned
         assert((virt_to_phys(virt) & ((1ul << (block->ord + PAGE_BITS)) - 1)) == 0);
 
-        fill(reinterpret_cast<void*>(virt), fill_mem, 1ul << (block->ord + PAGE_BITS));
-
         // We should never hand out a nullptr.
         assert(virt != 0);
 
-        return Ok(reinterpret_cast<void*>(virt));
+        return virt;
     }
 
-    trace(TRACE_ERROR, "Failed allocating %u pages from %p", 1U << ord, __builtin_return_address(0));
-    return Err(Out_of_memory_error());
+    return 0;
 }
 
 void* Buddy::alloc(unsigned short ord, Fill fill_mem)
@@ -133,6 +234,35 @@ void* Buddy::alloc(unsigned short ord, Fill fill_mem)
  */
 void Buddy::free(mword virt)
 {
+    // Blocks that are in use are not modified concurrently, so we can check the order without the lock.
+    if (use_page_cache() and index_to_block(page_to_index(virt))->ord == 0) {
+        assert(index_to_block(page_to_index(virt))->tag == Block::Used);
+
+        page_cache().free(virt, [this](mword const* pages, size_t n) { free_batch(pages, n); });
+        return;
+    }
+
+    Lock_guard<Spinlock> guard(lock);
+
+    free_locked(virt);
+}
+
+void Buddy::free_chain(mword virt)
+{
+    Lock_guard<Spinlock> guard(lock);
+
+    while (virt) {
+        mword const next{*reinterpret_cast<mword*>(virt)};
+
+        free_locked(virt);
+        virt = next;
+    }
+}
+
+void Buddy::free_locked(mword virt)
+{
+    assert(lock.is_locked());
+
     signed long idx = page_to_index(virt);
 
     // Ensure virt is within allocator range
@@ -146,8 +276,6 @@ void Buddy::free(mword virt)
     // Ensure corresponding physical block is order-aligned
     assert((virt_to_phys(virt) & ((1ul << (block->ord + PAGE_BITS)) - 1)) == 0);
 
-    Lock_guard<Spinlock> guard(lock);
-
     unsigned short ord;
     for (ord = block->ord; ord < order - 1; ord++) {
 
@@ -183,3 +311,11 @@ void Buddy::free(mword virt)
     block->next = h->next;
     block->next->prev = h->next = block;
 }
+
+Page_cache_stats Buddy::page_cache_stats(unsigned cpu)
+{
+    Per_cpu const& remote{Cpulocal::get_remote(cpu)};
+
+    // These are statistics, so we don't care about reading slightly outdated values.
+    return ::page_cache_stats(remote.buddy_page_cache, remote.buddy_zeroed_page_cache);
+}
@@ -23,8 +23,19 @@
 #include "string.hpp"
 
 struct Cmdline::param_map const Cmdline::map[] = {
-    {"serial", &Cmdline::serial}, {"nodl", &Cmdline::nodl},     {"nopcid", &Cmdline::nopcid},
-    {"novga", &Cmdline::novga},   {"novpid", &Cmdline::novpid},
+    {"serial", &Cmdline::serial},
+    {"nodl", &Cmdline::nodl},
+    {"noipcfast", &Cmdline::noipcfast},
+    {"nopcid", &Cmdline::nopcid},
+    {"nosysret", &Cmdline::nosysret},
+    {"novga", &Cmdline::novga},
+    {"novpid", &Cmdline::novpid},
+    {"nox2apic", &Cmdline::nox2apic},
+#ifdef BENCHMARKS
+    {"ipcbench", &Cmdline::ipcbench},
+    {"ipcremote", &Cmdline::ipcremote},
+    {"syscallbench", &Cmdline::syscallbench},
+#endif
 };
 
 char const* Cmdline::get_arg(char const** line, unsigned& len)
@@ -22,11 +22,14 @@
  */
 
 #include "ec.hpp"
+#include "cmdline.hpp"
 #include "elf.hpp"
 #include "extern.hpp"
+#include "gdt.hpp"
 #include "hip.hpp"
 #include "kp.hpp"
 #include "lapic.hpp"
+#include "pt.hpp"
 #include "rcu.hpp"
 #include "sm.hpp"
 #include "stdio.hpp"
@@ -39,7 +42,7 @@ Slab_cache Ec::cache(sizeof(Ec), 32);
 
 Ec::Ec(Pd* own, unsigned c)
     : Typed_kobject(static_cast<Space_obj*>(own)), cont(Ec::idle), pd(own), pd_user_page(own),
-      cpu(static_cast<uint16>(c)), glb(true), fpu(new Kp(own))
+      cpu(static_cast<uint16>(c)), glb(true), fpu(new Kp(own), Fpu::Format::COMPACT)
 {
     // The idle EC gets a Fpu and a KP for the Fpu, as this has the least complexity of all alternatives (e.g.
     // using an optional<Fpu> or having an Fpu that handles a nullptr in the constructor).
@@ -51,7 +54,7 @@ Ec::Ec(Pd* own, unsigned c)
 Ec::Ec(Pd* own, mword sel, Pd* p, void (*f)(), unsigned c, unsigned e, mword u, mword s, int creation_flags)
     : Typed_kobject(static_cast<Space_obj*>(own), sel, Ec::PERM_ALL, free, pre_free), cont(f), pd(p),
       pd_user_page((creation_flags & MAP_USER_PAGE_IN_OWNER) ? own : p), cpu(static_cast<uint16>(c)),
-      glb(!!f), evt(e), fpu(new Kp(own))
+      glb(!!f), evt(e), fpu(new Kp(own), Fpu::Format::COMPACT)
 {
     assert(u < USER_ADDR);
     assert((u & PAGE_MASK) == 0);
@@ -106,10 +109,7 @@ void Ec::handle_hazards(void (*continuation)())
     }
 
     if (hzd & HZD_TLB) {
-        if (Pd::current()->Space_mem::stale_host_tlb.chk(Cpu::id())) {
-            Pd::current()->Space_mem::stale_host_tlb.clr(Cpu::id());
-            Hpt::flush();
-        }
+        Pd::current()->Space_mem::invalidate_stale_host_tlb();
     }
 
     if (hzd & HZD_RRQ) {
@@ -126,47 +126,71 @@ void Ec::ret_user_sysexit()
 {
     handle_hazards(ret_user_sysexit);
 
-    // TODO Instead of exiting via sysret, which should trap due to the NMI handler, we just redirect
-    // everything to iret.
-    current()->redirect_to_iret();
-    ret_user_iret();
+    // SYSRET with a non-canonical RIP faults in kernel mode, but with the user stack already in place. The
+    // entry point of a portal is user controlled, so we let IRET deal with such addresses.
+    if (EXPECT_FALSE(Cmdline::nosysret or current()->regs.ARG_IP >= USER_ADDR)) {
+        current()->redirect_to_iret();
+        ret_user_iret();
+    }
 
-    // TODO This is not reached right now.
     assert_slow(Pd::is_pcid_valid());
 
+    Pseudo_descriptor gdtr{0, 0};
+
+    // Unlike IRET, SYSRET does not trap when an NMI has left only the kernel part of the GDT loaded, because
+    // it takes the user selectors from the STAR MSR. So we check for deferred NMI work ourselves. An NMI that
+    // arrives after this check finds its RIP between sysret_to_user_begin and sysret_to_user_end and does
+    // its work right away. See Ec::handle_exc_altstack.
+    //
     // clang-format off
-    asm volatile ("lea %[regs], %%rsp;"
-                  EXPAND (LOAD_GPR)
-
-                  // Restore the user stack and RFLAGS. SYSRET loads RFLAGS from
-                  // R11. See entry_sysenter.
-                  "mov %%r11, %%rsp;"
-                  "mov $0, %%r11;"
-
-                  "swapgs;"
-
-                  // When sysret triggers a #GP, it is delivered before the
-                  // switch to Ring3. Because we have already restored the user
-                  // stack pointer, this is dangerous. We would execute Ring0
-                  // code with a user accessible stack.
-                  //
-                  // See for example the Xen writeup about this problem:
-                  // https://xenproject.org/2012/06/13/the-intel-sysret-privilege-escalation/
-                  //
-                  // This issue is prevented by preventing user mappings at the
-                  // canonical boundary by setting USER_ADDR to one page before
-                  // the boundary and thus the RIP we return to cannot be
-                  // uncanonical.
-                  "sysretq;" : : [regs] "m" (current()->regs) : "memory");
+    asm goto (".globl sysret_to_user_begin;"
+              ".globl sysret_to_user_end;"
+
+              "sysret_to_user_begin:"
+              "sgdt %[gdtr];"
+              "cmpw %[limit], %[gdtr];"
+              "jne %l[deferred_nmi_work];"
+
+              "lea %[regs], %%rsp;"
+              EXPAND (LOAD_GPR)
+
+              // Restore the user stack and RFLAGS. SYSRET loads RFLAGS from
+              // R11. See entry_sysenter.
+              "mov %%r11, %%rsp;"
+              "mov $0, %%r11;"
+
+              "swapgs;"
+
+              // When sysret triggers a #GP, it is delivered before the
+              // switch to Ring3. Because we have already restored the user
+              // stack pointer, this is dangerous. We would execute Ring0
+              // code with a user accessible stack.
+              //
+              // See for example the Xen writeup about this problem:
+              // https://xenproject.org/2012/06/13/the-intel-sysret-privilege-escalation/
+              //
+              // This issue is prevented by preventing user mappings at the
+              // canonical boundary by setting USER_ADDR to one page before
+              // the boundary and by checking the RIP before we get here. Thus
+              // the RIP we return to cannot be uncanonical.
+              "sysretq;"
+              "sysret_to_user_end:"
+              :
+              : [regs] "m" (current()->regs), [gdtr] "m" (gdtr), [limit] "i" (Gdt::limit())
+              : "memory"
+              : deferred_nmi_work);
     // clang-format on
 
     UNREACHED;
+
+deferred_nmi_work:
+    // IRET to user space traps and handles the deferred NMI work. See Ec::maybe_handle_deferred_nmi_work.
+    current()->redirect_to_iret();
+    ret_user_iret();
 }
 
-void Ec::return_to_user()
+void Ec::set_entry_stacks()
 {
-    make_current();
-
     // Set the stack behind the iret frame in Exc_regs for entry via
     // interrupts.
     auto const kern_sp{reinterpret_cast<mword>(&exc_regs()->ss + 1)};
@@ -181,12 +205,30 @@ void Ec::return_to_user()
     // This is where registers will be pushed in the system call entry path.
     // See entry_sysenter.
     Cpulocal::set_sys_entry_stack(sys_regs() + 1);
+}
+
+void Ec::return_to_user()
+{
+    make_current();
+    set_entry_stacks();
 
     // Reset the kernel stack and jump to the current continuation.
     asm volatile("mov %%gs:0, %%rsp; jmp *%[cont]" : : [cont] "q"(cont) : "memory");
     UNREACHED;
 }
 
+void Ec::return_to_user_sysexit()
+{
+    assert(cont == ret_user_sysexit);
+
+    make_current();
+    set_entry_stacks();
+
+    // There is no need to reset the kernel stack, because ret_user_sysexit either leaves the kernel or
+    // resets the stack itself before it continues elsewhere.
+    ret_user_sysexit();
+}
+
 void Ec::ret_user_iret()
 {
     handle_hazards(ret_user_iret);
@@ -245,6 +287,12 @@ void Ec::idle()
     for (;;) {
         handle_hazards(idle);
 
+        // Use idle time to zero free pages. We only zero a single page at a time to check for hazards in
+        // between.
+        if (Buddy::allocator.prezero_page()) {
+            continue;
+        }
+
         // In case the CPU doesn't support MONITOR/MWAIT, the idle loop is basically a busy loop. This is
         // fine, because the passthrough VM is expected to the case where the system is idle.
         //
@@ -275,6 +323,16 @@ void Ec::idle()
 
 void Ec::root_invoke()
 {
+#ifdef BENCHMARKS
+    if (Cmdline::syscallbench) {
+        root_invoke_syscall_bench();
+    }
+
+    if (Cmdline::ipcbench) {
+        root_invoke_ipc_bench();
+    }
+#endif
+
     Eh* e = static_cast<Eh*>(Hpt::remap(Hip::root_addr, false));
     if (!Hip::root_addr || e->ei_magic != 0x464c457f || e->ei_class != ELF_CLASS || e->ei_data != 1 ||
         e->type != 2 || e->machine != ELF_MACHINE)
@@ -365,6 +423,9 @@ void Ec::die(char const* reason, Exc_regs* r)
 
     Ec* ec = current()->rcap;
 
+    if (ec and ec->cpu != current()->cpu)
+        reply_remote(dead, sys_finish<Sys_regs::COM_ABT>);
+
     if (ec)
         ec->cont =
             ec->cont == ret_user_sysexit ? static_cast<void (*)()>(sys_finish<Sys_regs::COM_ABT>) : dead;
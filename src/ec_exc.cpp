@@ -98,6 +98,11 @@ void Ec::do_early_nmi_work()
     // The caller of this function has to make sure that we can access CPU-local data.
     assert_slow(Cpulocal::is_initialized());
 
+    // Allow other CPUs to send us NMIs again. This has to happen before we acknowledge the TLB invalidation
+    // request: a CPU that sees a pending kick relies on the shootdown counter to change afterwards. See
+    // Lapic::kick.
+    Atomic::store(Cpu::kick_pending(), false);
+
     // Acknowledge the TLB invalidation request. We promise to flush the TLB before we execute any user/guest
     // code.
     Atomic::add(Counter::tlb_shootdown(), static_cast<uint16>(1));
@@ -118,10 +123,7 @@ void Ec::do_deferred_nmi_work()
 
     // Handle a stale TLB.
     if ((Atomic::load(Cpu::hazard()) & HZD_TLB) != 0) {
-        if (Pd::current()->Space_mem::stale_host_tlb.chk(Cpu::id())) {
-            Pd::current()->Space_mem::stale_host_tlb.clr(Cpu::id());
-            Hpt::flush();
-        }
+        Pd::current()->Space_mem::invalidate_stale_host_tlb();
         Atomic::clr_mask(Cpu::hazard(), HZD_TLB);
     }
 
@@ -130,9 +132,11 @@ void Ec::do_deferred_nmi_work()
         Atomic::clr_mask(Cpu::hazard(), HZD_RCU);
     }
 
+    // Clear the hazard before draining the queue. Otherwise, we could lose the hazard of an SC that is
+    // enqueued right after we drained the queue.
     if ((Atomic::load(Cpu::hazard()) & HZD_RRQ) != 0) {
-        Sc::rrq_handler();
         Atomic::clr_mask(Cpu::hazard(), HZD_RRQ);
+        Sc::rrq_handler();
     }
 }
 
@@ -268,11 +272,27 @@ void Ec::handle_exc_altstack(Exc_regs* r)
             swapgs();
         }
 
+        // If we interrupted the return to user space via SYSRET, it has already checked for deferred NMI work
+        // and will not trap, because SYSRET doesn't consult the GDT. But we also know that the kernel doesn't
+        // hold any locks at this point and that the register state that it is about to load won't change. So
+        // we can do the deferred work right here, just as if we had interrupted user space.
+        else if (r->rip >= reinterpret_cast<mword>(&sysret_to_user_begin) and
+                 r->rip < reinterpret_cast<mword>(&sysret_to_user_end)) {
+
+            // Cpulocal::restore_for_nmi has already loaded the GS base of the kernel, which SYSRET may have
+            // swapped out already.
+            assert_slow(Cpulocal::is_initialized());
+
+            do_deferred_nmi_work();
+
+            wrgsbase(old_gs_base);
+        }
+
         // If we interrupted the kernel we defer the NMI work until the next exit to user space, or until the
         // next vmresume. To do that, we
-        //   - load only the kernel part of the GDT, that way iret to user space will generate a #GP. We
-        //     currently redirect Ec::ret_user_sysret to Ec::ret_user_iret, thus this also handles the
-        //     sysret. (Check Ec::handle_exc for more information)
+        //   - load only the kernel part of the GDT, that way iret to user space will generate a #GP. Before
+        //     Ec::ret_user_sysexit uses sysret, it checks the GDT and takes the iret path instead. (Check
+        //     Ec::handle_exc for more information)
         //   - write a 0 into Vmcs::HOST_SEL_CS. This will make the host state checks during VM-entry
         //     fail. (Check Vcpu::maybe_handle_invalid_guest_state for more information)
         // That way we know that we do the deferred NMI work at safe places.
@@ -42,7 +42,7 @@ void Fpu::probe()
         panic("Need XSAVE-capable CPU");
     }
 
-    uint32 valid_xcr0_lo, valid_xcr0_hi, current_context, discard;
+    uint32 valid_xcr0_lo, valid_xcr0_hi, current_context, compact_context, discard;
     uint64 xcr0;
 
     cpuid(0xD, 0, valid_xcr0_lo, discard, discard, valid_xcr0_hi);
@@ -52,11 +52,23 @@ void Fpu::probe()
     xsave_enable(xcr0);
 
     cpuid(0xD, 0, discard, current_context, discard, discard);
+    cpuid(0xD, 1, discard, compact_context, discard, discard);
 
-    Fpu::config = {xcr0, current_context,
-                   Cpu::feature(Cpu::FEAT_XSAVEOPT) ? Fpu::Mode::XSAVEOPT : Fpu::Mode::XSAVE};
+    Fpu::Mode const mode{Cpu::feature(Cpu::FEAT_XSAVEOPT) ? Fpu::Mode::XSAVEOPT : Fpu::Mode::XSAVE};
 
-    if (Fpu::config.context_size > PAGE_SIZE) {
+    // XSAVES adds the modified optimization to the init optimization of XSAVEC. We never enable supervisor
+    // state components, so both produce the same layout.
+    Fpu::Mode compact_mode{mode};
+
+    if (Cpu::feature(Cpu::FEAT_XSAVES)) {
+        compact_mode = Fpu::Mode::XSAVES;
+    } else if (Cpu::feature(Cpu::FEAT_XSAVEC)) {
+        compact_mode = Fpu::Mode::XSAVEC;
+    }
+
+    Fpu::config = {xcr0, current_context, mode, compact_mode};
+
+    if (Fpu::config.context_size > PAGE_SIZE or compact_context > PAGE_SIZE) {
         panic("Context size is too large for a kernel-page.");
     }
 }
@@ -74,7 +86,13 @@ void Fpu::save()
     uint32 xsave_scb_hi{static_cast<uint32>(config.xsave_scb >> 32)};
     uint32 xsave_scb_lo{static_cast<uint32>(config.xsave_scb)};
 
-    switch (config.mode) {
+    switch (mode_) {
+    case Mode::XSAVES:
+        asm volatile("xsaves %0" : "=m"(*data()) : "d"(xsave_scb_hi), "a"(xsave_scb_lo) : "memory");
+        break;
+    case Mode::XSAVEC:
+        asm volatile("xsavec %0" : "=m"(*data()) : "d"(xsave_scb_hi), "a"(xsave_scb_lo) : "memory");
+        break;
     case Mode::XSAVEOPT:
         asm volatile("xsaveopt %0" : "=m"(*data()) : "d"(xsave_scb_hi), "a"(xsave_scb_lo) : "memory");
         break;
@@ -89,7 +107,13 @@ void Fpu::load()
     uint32 xsave_scb_hi{static_cast<uint32>(config.xsave_scb >> 32)};
     uint32 xsave_scb_lo{static_cast<uint32>(config.xsave_scb)};
 
-    asm volatile("xrstor %0" : : "m"(*data()), "d"(xsave_scb_hi), "a"(xsave_scb_lo) : "memory");
+    // XRSTOR understands both formats, but only XRSTORS keeps track of the context for the modified
+    // optimization of XSAVES.
+    if (mode_ == Mode::XSAVES) {
+        asm volatile("xrstors %0" : : "m"(*data()), "d"(xsave_scb_hi), "a"(xsave_scb_lo) : "memory");
+    } else {
+        asm volatile("xrstor %0" : : "m"(*data()), "d"(xsave_scb_hi), "a"(xsave_scb_lo) : "memory");
+    }
 }
 
 bool Fpu::load_from_user()
@@ -135,9 +159,16 @@ bool Fpu::load_xcr0(uint64 xcr0)
 
 void Fpu::restore_xcr0() { set_xcr(0, config.xsave_scb); }
 
-Fpu::Fpu(Kp* data_kp) : data_(data_kp)
+Fpu::Fpu(Kp* data_kp, Format format)
+    : data_(data_kp), mode_(format == Format::COMPACT ? config.compact_mode : config.mode)
 {
     // Mask exceptions by default according to SysV ABI spec.
     data()->legacy_hdr.fcw = 0x37f;
     data()->legacy_hdr.mxcsr = 0x1f80;
+
+    // A compacted context has to be marked as such, before we can restore from it. With XSTATE_BV being zero,
+    // all components start in their initial configuration.
+    if (mode_ == Mode::XSAVES or mode_ == Mode::XSAVEC) {
+        data()->xsave_hdr.xcomp_bv = XCOMP_BV_COMPACT | config.xsave_scb;
+    }
 }
@@ -85,6 +85,7 @@ void* Hpt::remap(Paddr phys, bool use_boot_hpt)
 
     // We always need to flush the TLB.
     hpt.flush();
+    cleanup.ignore_tlb_flush();
 
     return reinterpret_cast<void*>(SPC_LOCAL_REMAP + offset);
 }
@@ -50,7 +50,7 @@ Kp::~Kp()
 
 bool Kp::has_user_mapping() const { return pd_user_page and addr_in_user_space <= INVALID_USER_ADDR; }
 
-bool Kp::add_user_mapping(Pd* pd, mword addr)
+bool Kp::add_user_mapping(Pd* pd, mword addr, bool writable)
 {
     Tlb_cleanup cleanup;
 
@@ -73,16 +73,20 @@ bool Kp::add_user_mapping(Pd* pd, mword addr)
 
         addr_in_user_space = addr;
 
-        cleanup = pd_user_page->Space_mem::insert(
-            user_address(), 0, Hpt::PTE_NODELEG | Hpt::PTE_NX | Hpt::PTE_U | Hpt::PTE_W | Hpt::PTE_P,
-            Buddy::ptr_to_phys(data));
+        Hpt::pte_t attr{Hpt::PTE_NODELEG | Hpt::PTE_NX | Hpt::PTE_U | Hpt::PTE_P};
+        if (writable) {
+            attr |= Hpt::PTE_W;
+        }
+
+        cleanup = pd_user_page->Space_mem::insert(user_address(), 0, attr, Buddy::ptr_to_phys(data));
     }
 
     if (cleanup.need_tlb_flush()) {
         // We don't want to access pd_user_page in an unsynchronized scope, thus we use the pd variable for
         // the shootdown. At this point we already checked whether we can use the pd.
-        pd->stale_host_tlb.merge(pd->Space_mem::cpus);
+        pd->Space_mem::mark_host_tlb_stale(cleanup);
         pd->Space_mem::shootdown();
+        cleanup.ignore_tlb_flush(); // because it is done.
     }
 
     return true;
@@ -127,8 +131,9 @@ bool Kp::remove_user_mapping()
     }
 
     if (cleanup.need_tlb_flush()) {
-        pd->stale_host_tlb.merge(pd->Space_mem::cpus);
+        pd->Space_mem::mark_host_tlb_stale(cleanup);
         pd->Space_mem::shootdown();
+        cleanup.ignore_tlb_flush(); // because it is done.
     }
 
     return true;
@@ -86,7 +86,19 @@ void Lapic::restore_low_memory()
 void Lapic::init()
 {
     Paddr apic_base = Msr::read(Msr::IA32_APIC_BASE);
-    Msr::write(Msr::IA32_APIC_BASE, apic_base | 0x800);
+
+    // The BSP runs first and decides for all CPUs whether we use x2APIC mode. If the firmware has already
+    // enabled x2APIC mode, we can't go back to xAPIC mode without disabling the LAPIC.
+    if (apic_base & APIC_BASE_BSP) {
+        x2apic = Cpu::feature(Cpu::FEAT_X2APIC) and ((apic_base & APIC_BASE_EXTD) or not Cmdline::nox2apic);
+    }
+
+    // Switching into x2APIC mode requires the xAPIC to be enabled first.
+    Msr::write(Msr::IA32_APIC_BASE, apic_base | APIC_BASE_EN);
+
+    if (x2apic) {
+        Msr::write(Msr::IA32_APIC_BASE, apic_base | APIC_BASE_EN | APIC_BASE_EXTD);
+    }
 
     assert_slow(Cpu::find_by_apic_id(id()) == Optional{Cpu::id()});
 
@@ -94,7 +106,7 @@ void Lapic::init()
     if (!(svr & 0x100))
         write(LAPIC_SVR, svr | 0x100);
 
-    if ((Cpu::bsp() = apic_base & 0x100)) {
+    if ((Cpu::bsp() = apic_base & APIC_BASE_BSP)) {
         uint32 const boot_addr = prepare_cpu_boot(cpu_boot_type::AP);
 
         send_ipi(0, 0, DLV_INIT, DSH_EXC_SELF);
@@ -117,17 +129,42 @@ void Lapic::init()
         send_ipi(0, boot_addr >> PAGE_BITS, DLV_SIPI, DSH_EXC_SELF);
     }
 
-    trace(TRACE_APIC, "APIC:%#lx ID:%#x VER:%#x LVT:%#x", apic_base & ~PAGE_MASK, id(), version(), lvt_max());
+    trace(TRACE_APIC, "APIC:%#lx ID:%#x VER:%#x LVT:%#x%s", apic_base & ~PAGE_MASK, id(), version(),
+          lvt_max(), x2apic ? " x2APIC" : "");
 }
 
 void Lapic::send_ipi(unsigned cpu, unsigned vector, Delivery_mode dlv, Shorthand dsh)
 {
-    wait_for_idle();
-
     if (dlv != DLV_INIT and dlv != DLV_SIPI and dlv != DLV_NMI) {
         panic("Hedron does not support sending IPIs anymore, except for delivery modes INIT, SIPI and NMI.");
     }
 
+    uint32 const icr_lo{dsh | 1U << 14 | dlv | vector};
+
+    if (x2apic) {
+        send_ipi_x2apic(cpu, icr_lo, dsh);
+    } else {
+        send_ipi_xapic(cpu, icr_lo, dsh);
+    }
+}
+
+void Lapic::send_ipi_x2apic(unsigned cpu, uint32 icr_lo, Shorthand dsh)
+{
+    uint64 const dst{dsh == DSH_NONE ? static_cast<uint64>(Cpu::apic_id[cpu]) << 32 : 0};
+
+    // WRMSR to the x2APIC ICR is not serializing. Make sure that all our memory writes (e.g. hazards) are
+    // visible before the IPI arrives. See Intel SDM Vol. 3 Chap. 10.12.3 "MSR Access in x2APIC Mode".
+    asm volatile("mfence; lfence" : : : "memory");
+
+    // In x2APIC mode, the ICR is written with a single MSR write and there is no ICR_HI that we could trash
+    // for the passthrough guest. We also don't have to wait for the IPI to be sent.
+    Msr::write(Msr::IA32_EXT_XAPIC_ICR, dst | icr_lo);
+}
+
+void Lapic::send_ipi_xapic(unsigned cpu, uint32 icr_lo, Shorthand dsh)
+{
+    wait_for_idle();
+
     // We have to make sure that we do not trash anything that the guest already wrote into ICR_HI. Thus we
     // unconditionally read ICR_HI here and write the read value back after sending our IPI.
     const uint32 icr_hi_old{read(LAPIC_ICR_HI)};
@@ -139,7 +176,7 @@ void Lapic::send_ipi(unsigned cpu, unsigned vector, Delivery_mode dlv, Shorthand
         // If no shorthand is used, we have to write the upper part of the ICR.
         write(LAPIC_ICR_HI, Cpu::apic_id[cpu] << 24);
     }
-    write(LAPIC_ICR_LO, dsh | 1U << 14 | dlv | vector);
+    write(LAPIC_ICR_LO, icr_lo);
 
     // We have to wait here until the LAPIC clears delivery_status.send_pending.
     // Otherwise, our IPI may be sent to the wrong destination because we
@@ -158,6 +195,24 @@ bool Lapic::send_nmi(unsigned cpu)
     return true;
 }
 
+bool Lapic::kick(unsigned cpu, unsigned hazards)
+{
+    Atomic::set_mask(Cpu::hazard(cpu), hazards);
+
+    // The flag is cleared by the remote CPU when the NMI arrives. Until then, all hazards that we have set
+    // will be seen by the remote CPU anyway and we don't need to send another NMI.
+    if (Atomic::exchange(Cpu::remote_ref_kick_pending(cpu), true)) {
+        return true;
+    }
+
+    if (EXPECT_FALSE(not send_nmi(cpu))) {
+        Atomic::store(Cpu::remote_ref_kick_pending(cpu), false);
+        return false;
+    }
+
+    return true;
+}
+
 void Lapic::park_all_but_self(park_fn fn)
 {
     assert(Atomic::load(cpu_park_count) == 0);
@@ -171,8 +226,7 @@ void Lapic::park_all_but_self(park_fn fn)
             continue;
         }
 
-        Atomic::set_mask(Cpu::hazard(cpu), HZD_PRK);
-        Lapic::send_nmi(cpu);
+        kick(cpu, HZD_PRK);
     }
 
     while (Atomic::load(cpu_park_count) != 0) {
@@ -0,0 +1,28 @@
+/*
+ * Notification
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+#include "notification.hpp"
+#include "stdio.hpp"
+
+INIT_PRIORITY(PRIO_SLAB)
+Slab_cache Notification::cache(sizeof(Notification), 32);
+
+Notification::Notification(Pd* own, mword sel)
+    : Typed_kobject(static_cast<Space_obj*>(own), sel, Notification::PERM_ALL, free)
+{
+    trace(TRACE_SYSCALL, "NOTIFICATION:%p created", this);
+}
@@ -168,19 +168,6 @@ template <typename S> void Pd::revoke(mword const base, mword const ord, mword c
     }
 }
 
-template <> void Pd::revoke<Space_mem>(mword const base, mword const ord, mword const attr, bool self)
-{
-    if (not self) {
-        trace(TRACE_ERROR, "Non-self revocation is not supported: Revoking everything!");
-    }
-
-    Tlb_cleanup cleanup;
-    Space_mem::revoke(cleanup, base << PAGE_BITS, ord + PAGE_BITS, attr);
-
-    shootdown();
-    cleanup.ignore_tlb_flush(); // because it is done.
-}
-
 mword Pd::clamp(mword snd_base, mword& rcv_base, mword snd_ord, mword rcv_ord)
 {
     if ((snd_base ^ rcv_base) >> max(snd_ord, rcv_ord))
@@ -265,10 +252,10 @@ void Pd::xlt_crd(Pd* pd, Crd xlt, Crd& crd)
     crd = Crd(0);
 }
 
-Delegate_result_void Pd::del_crd(Pd* pd, Crd del, Crd& crd, mword sub, mword hot)
+Delegate_result_void Pd::del_crd(Tlb_cleanup& cleanup, Pd* pd, Crd del, Crd& crd, mword sub, mword hot)
 {
     Crd::Type st = crd.type(), rt = del.type();
-    Tlb_cleanup cleanup;
+    Tlb_cleanup del_cleanup;
 
     mword a = crd.attr() & del.attr(), sb = crd.base(), so = crd.order(), rb = del.base(), ro = del.order(),
           o = 0;
@@ -279,16 +266,13 @@ Delegate_result_void Pd::del_crd(Pd* pd, Crd del, Crd& crd, mword sub, mword hot
     }
 
     // Regardless of whether the delegate operations below fail or succeed, they might have done operations
-    // that require TLB flushing.
-    auto guard{Scope_guard([this, &cleanup, rt]() {
-        if (cleanup.need_tlb_flush() && rt == Crd::OBJ)
-            /* if FRAME_0 got replaced by real pages we have to tell all cpus, done below by shootdown */
-            this->stale_host_tlb.merge(cpus);
+    // that require TLB flushing. The caller does the shootdown.
+    auto guard{Scope_guard([this, &cleanup, &del_cleanup, rt]() {
+        if (del_cleanup.need_tlb_flush() && rt == Crd::OBJ)
+            /* if FRAME_0 got replaced by real pages we have to tell all cpus */
+            this->mark_host_tlb_stale(del_cleanup);
 
-        if (cleanup.need_tlb_flush()) {
-            shootdown();
-            cleanup.ignore_tlb_flush(); // because it is done.
-        }
+        cleanup.merge(del_cleanup);
     })};
 
     switch (rt) {
@@ -296,19 +280,19 @@ Delegate_result_void Pd::del_crd(Pd* pd, Crd del, Crd& crd, mword sub, mword hot
     case Crd::MEM:
         o = clamp(sb, rb, so, ro, hot);
         trace(TRACE_DEL, "DEL MEM PD:%p->%p SB:%#010lx RB:%#010lx O:%#04lx A:%#lx", pd, this, sb, rb, o, a);
-        TRY_OR_RETURN(delegate<Space_mem>(cleanup, pd, sb, rb, o, a, sub, "MEM"));
+        TRY_OR_RETURN(delegate<Space_mem>(del_cleanup, pd, sb, rb, o, a, sub, "MEM"));
         break;
 
     case Crd::PIO:
         o = clamp(sb, rb, so, ro);
         trace(TRACE_DEL, "DEL I/O PD:%p->%p SB:%#010lx RB:%#010lx O:%#04lx A:%#lx", pd, this, rb, rb, o, a);
-        TRY_OR_RETURN(delegate<Space_pio>(cleanup, pd, rb, rb, o, a, sub, "PIO"));
+        TRY_OR_RETURN(delegate<Space_pio>(del_cleanup, pd, rb, rb, o, a, sub, "PIO"));
         break;
 
     case Crd::OBJ:
         o = clamp(sb, rb, so, ro, hot);
         trace(TRACE_DEL, "DEL OBJ PD:%p->%p SB:%#010lx RB:%#010lx O:%#04lx A:%#lx", pd, this, sb, rb, o, a);
-        TRY_OR_RETURN(delegate<Space_obj>(cleanup, pd, sb, rb, o, a, 0, "OBJ"));
+        TRY_OR_RETURN(delegate<Space_obj>(del_cleanup, pd, sb, rb, o, a, 0, "OBJ"));
         break;
     }
 
@@ -317,14 +301,46 @@ Delegate_result_void Pd::del_crd(Pd* pd, Crd del, Crd& crd, mword sub, mword hot
     return Ok_void({});
 }
 
+Delegate_result_void Pd::del_crd(Pd* pd, Crd del, Crd& crd, mword sub, mword hot)
+{
+    Tlb_cleanup cleanup;
+
+    auto guard{Scope_guard([&cleanup]() {
+        if (cleanup.need_tlb_flush()) {
+            shootdown();
+            cleanup.ignore_tlb_flush(); // because it is done.
+        }
+    })};
+
+    return del_crd(cleanup, pd, del, crd, sub, hot);
+}
+
 void Pd::rev_crd(Crd crd, bool self)
+{
+    Tlb_cleanup cleanup;
+    rev_crd(cleanup, crd, self);
+
+    // Memory revocations always need a shootdown. Even if nothing was mapped anymore, a concurrent revocation
+    // of the same region may not have finished its shootdown yet.
+    if (crd.type() == Crd::MEM) {
+        shootdown();
+        cleanup.ignore_tlb_flush(); // because it is done.
+    }
+}
+
+void Pd::rev_crd(Tlb_cleanup& cleanup, Crd crd, bool self)
 {
     switch (crd.type()) {
 
     case Crd::MEM:
         trace(TRACE_REV, "REV MEM PD:%p B:%#010lx O:%#04x A:%#04x %s", this, crd.base(), crd.order(),
               crd.attr(), self ? "+" : "-");
-        revoke<Space_mem>(crd.base(), crd.order(), crd.attr(), self);
+
+        if (not self) {
+            trace(TRACE_ERROR, "Non-self revocation is not supported: Revoking everything!");
+        }
+
+        Space_mem::revoke(cleanup, crd.base() << PAGE_BITS, crd.order() + PAGE_BITS, crd.attr());
         break;
 
     case Crd::PIO:
@@ -342,6 +358,20 @@ void Pd::rev_crd(Crd crd, bool self)
 }
 
 Delegate_result<Xfer> Pd::xfer_item(Pd* src_pd, Crd xlt, Crd del, Xfer s_ti)
+{
+    Tlb_cleanup cleanup;
+
+    auto guard{Scope_guard([&cleanup]() {
+        if (cleanup.need_tlb_flush()) {
+            shootdown();
+            cleanup.ignore_tlb_flush(); // because it is done.
+        }
+    })};
+
+    return xfer_item(cleanup, src_pd, xlt, del, s_ti);
+}
+
+Delegate_result<Xfer> Pd::xfer_item(Tlb_cleanup& cleanup, Pd* src_pd, Crd xlt, Crd del, Xfer s_ti)
 {
     mword set_as_del = 0;
     Crd crd = s_ti.crd();
@@ -362,7 +392,7 @@ Delegate_result<Xfer> Pd::xfer_item(Pd* src_pd, Crd xlt, Crd del, Xfer s_ti)
         set_as_del = 1;
         [[fallthrough]];
     case Xfer::Kind::DELEGATE:
-        TRY_OR_RETURN(del_crd(src_pd->is_priv && s_ti.from_kern() ? &kern : src_pd, del, crd,
+        TRY_OR_RETURN(del_crd(cleanup, src_pd->is_priv && s_ti.from_kern() ? &kern : src_pd, del, crd,
                               s_ti.subspaces(), s_ti.hotspot()));
         break;
 
@@ -377,8 +407,18 @@ Delegate_result<Xfer> Pd::xfer_item(Pd* src_pd, Crd xlt, Crd del, Xfer s_ti)
 Delegate_result_void Pd::xfer_items(Pd* src_pd, Crd xlt, Crd del, Xfer* s_ti, Xfer* d_ti,
                                     unsigned long num_typed)
 {
+    // All items share a single shootdown.
+    Tlb_cleanup cleanup;
+
+    auto guard{Scope_guard([&cleanup]() {
+        if (cleanup.need_tlb_flush()) {
+            shootdown();
+            cleanup.ignore_tlb_flush(); // because it is done.
+        }
+    })};
+
     for (unsigned long cur = 0; cur < num_typed; cur++) {
-        Xfer res{TRY_OR_RETURN(xfer_item(src_pd, xlt, del, *(s_ti - cur)))};
+        Xfer res{TRY_OR_RETURN(xfer_item(cleanup, src_pd, xlt, del, *(s_ti - cur)))};
 
         if (d_ti) {
             *(d_ti - cur) = res;
@@ -91,8 +91,7 @@ void Rcu::update()
             if (!Hip::cpu_online(cpu) || Cpu::id() == cpu)
                 continue;
 
-            Atomic::set_mask(Cpu::hazard(cpu), HZD_IDL);
-            Lapic::send_nmi(cpu);
+            Lapic::kick(cpu, HZD_IDL);
         }
 
     if (!done().empty())
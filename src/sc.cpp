@@ -55,18 +55,9 @@ void Sc::ready_enqueue(uint64 t, bool inc_ref)
             return;
     }
 
-    if (prio > prio_top())
-        prio_top() = prio;
+    ready().enqueue(this);
 
-    if (!list()[prio])
-        list()[prio] = prev = next = this;
-    else {
-        next = list()[prio];
-        prev = list()[prio]->prev;
-        next->prev = prev->next = this;
-    }
-
-    trace(TRACE_SCHEDULE, "ENQ:%p PRIO:%#x TOP:%#x %s", this, prio, prio_top(),
+    trace(TRACE_SCHEDULE, "ENQ:%p PRIO:%#x TOP:%#x %s", this, prio, ready().top_prio(),
           prio > current()->prio ? "reschedule" : "");
 
     if (prio > current()->prio) {
@@ -80,19 +71,10 @@ void Sc::ready_dequeue(uint64 t)
 {
     assert(prio < NUM_PRIORITIES);
     assert(cpu == Cpu::id());
-    assert(prev && next);
-
-    if (list()[prio] == this)
-        list()[prio] = next == this ? nullptr : next;
 
-    next->prev = prev;
-    prev->next = next;
-    prev = next = nullptr;
+    ready().dequeue(this);
 
-    while (!list()[prio_top()] && prio_top())
-        prio_top()--;
-
-    trace(TRACE_SCHEDULE, "DEQ:%p PRIO:%#x TOP:%#x", this, prio, prio_top());
+    trace(TRACE_SCHEDULE, "DEQ:%p PRIO:%#x TOP:%#x", this, prio, ready().top_prio());
 
     tsc = t;
 }
@@ -110,7 +92,7 @@ void Sc::schedule(bool suspend)
     else if (current()->del_rcu())
         Rcu::call(current());
 
-    Sc* sc = list()[prio_top()];
+    Sc* sc = ready().top();
     assert(sc);
 
     ctr_loop() = 0;
@@ -133,18 +115,10 @@ void Sc::remote_enqueue(bool inc_ref)
                 return;
         }
 
-        Rq* r = remote(cpu);
-
-        Lock_guard<Spinlock> guard(r->lock);
-
-        if (r->queue) {
-            next = r->queue;
-            prev = r->queue->prev;
-            next->prev = prev->next = this;
-        } else {
-            r->queue = prev = next = this;
-            Atomic::set_mask(Cpu::hazard(cpu), HZD_RRQ);
-            Lapic::send_nmi(cpu);
+        // Only the CPU that makes the remote queue non-empty needs to notify the remote CPU. Everyone else
+        // piggybacks on the pending notification.
+        if (remote(cpu)->enqueue(this)) {
+            Lapic::kick(cpu, HZD_RRQ);
         }
     }
 }
@@ -153,19 +127,5 @@ void Sc::rrq_handler()
 {
     uint64 t = rdtsc();
 
-    Lock_guard<Spinlock> guard(rq().lock);
-
-    for (Sc* ptr = rq().queue; ptr;) {
-
-        ptr->next->prev = ptr->prev;
-        ptr->prev->next = ptr->next;
-
-        Sc* sc = ptr;
-
-        ptr = ptr->next == ptr ? nullptr : ptr->next;
-
-        sc->ready_enqueue(t, false);
-    }
-
-    rq().queue = nullptr;
+    rq().drain([t](Sc* sc) { sc->ready_enqueue(t, false); });
 }
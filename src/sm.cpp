@@ -24,8 +24,13 @@
 INIT_PRIORITY(PRIO_SLAB)
 Slab_cache Sm::cache(sizeof(Sm), 32);
 
-Sm::Sm(Pd* own, mword sel, mword cnt)
-    : Typed_kobject(static_cast<Space_obj*>(own), sel, Sm::PERM_ALL, free), counter(cnt)
+Sm::Sm(Pd* own, mword sel, mword cnt, Kp* k, mword offset)
+    : Typed_kobject(static_cast<Space_obj*>(own), sel, Sm::PERM_ALL, free), counter(k ? 0 : cnt), kp(k),
+      user_counter(kp ? reinterpret_cast<int64*>(static_cast<char*>(kp->data_page()) + offset) : nullptr)
 {
-    trace(TRACE_SYSCALL, "SM:%p created (CNT:%lu)", this, cnt);
+    if (user_counter) {
+        Atomic::store(*user_counter, static_cast<int64>(cnt));
+    }
+
+    trace(TRACE_SYSCALL, "SM:%p created (CNT:%lu KP:%p)", this, cnt, k);
 }
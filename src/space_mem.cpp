@@ -76,17 +76,23 @@ Delegate_result_void Space_mem::delegate(Tlb_cleanup& cleanup, Space_mem* snd, m
         return Ok_void({});
     }
 
+    // We track guest and host page table changes separately, because the host TLB can be invalidated
+    // selectively, but only for pages of the host page table.
+    Tlb_cleanup guest_cleanup;
+    Tlb_cleanup host_cleanup;
+
     // Regardless of whether the operation was a success, we must take care of the TLB to not leave old
     // mappings around, even if we only managed a partial page table update.
-    Scope_guard g{[this, &cleanup, sub] {
-        if (cleanup.need_tlb_flush()) {
-            if (sub & Space::SUBSPACE_GUEST) {
-                stale_guest_tlb.merge(cpus);
-            }
-            if (sub & Space::SUBSPACE_HOST) {
-                stale_host_tlb.merge(cpus);
-            }
+    Scope_guard g{[this, &cleanup, &guest_cleanup, &host_cleanup] {
+        if (guest_cleanup.need_tlb_flush()) {
+            stale_guest_tlb.merge(cpus);
+        }
+        if (host_cleanup.need_tlb_flush()) {
+            mark_host_tlb_stale(host_cleanup);
         }
+
+        cleanup.merge(guest_cleanup);
+        cleanup.merge(host_cleanup);
     }};
 
     Hpt::pte_t const hw_attr{Hpt::hw_attr(attr)};
@@ -112,11 +118,11 @@ Delegate_result_void Space_mem::delegate(Tlb_cleanup& cleanup, Space_mem* snd, m
         }
 
         if (sub & Space::SUBSPACE_GUEST) {
-            TRY_OR_RETURN(ept.update(cleanup, Ept::convert_mapping(target_mapping)));
+            TRY_OR_RETURN(ept.update(guest_cleanup, Ept::convert_mapping(target_mapping)));
         }
 
         if (sub & Space::SUBSPACE_HOST) {
-            TRY_OR_RETURN(hpt.update(cleanup, target_mapping));
+            TRY_OR_RETURN(hpt.update(host_cleanup, target_mapping));
         }
 
         assert(clamped.size() >= target_mapping.size());
@@ -140,6 +146,81 @@ void Space_mem::revoke(Tlb_cleanup& cleanup, mword vaddr, mword ord, mword attr)
         .unwrap("Failed to revoke memory");
 }
 
+void Space_mem::mark_host_tlb_stale(Tlb_cleanup const& cleanup)
+{
+    assert(cleanup.need_tlb_flush());
+
+    for (unsigned cpu = 0; cpu < NUM_CPU; cpu++) {
+        if (!cpus.chk(cpu)) {
+            continue;
+        }
+
+        Tlb_pending& pending{remote_ref_tlb_pending(cpu)};
+        Lock_guard<Spinlock> guard{pending.lock};
+
+        if (pending.ranges.empty()) {
+            pending.space = this;
+        }
+
+        // We can only track pages of a single address space. Any other address space gets a full flush.
+        if (pending.space == this) {
+            pending.ranges.merge(cleanup.ranges());
+        } else {
+            pending.ranges.add_full();
+        }
+    }
+
+    // The pending invalidations must be visible before the remote CPU can observe the stale bit.
+    stale_host_tlb.merge(cpus);
+}
+
+void Space_mem::invalidate_stale_host_tlb()
+{
+    if (!stale_host_tlb.chk(Cpu::id())) {
+        return;
+    }
+
+    stale_host_tlb.clr(Cpu::id());
+
+    Tlb_ranges ranges;
+    bool own_ranges;
+
+    {
+        Tlb_pending& pending{tlb_pending()};
+        Lock_guard<Spinlock> guard{pending.lock};
+
+        ranges = pending.ranges;
+        own_ranges = pending.space == this;
+
+        pending.ranges.clear();
+        pending.space = nullptr;
+    }
+
+    // The ranges may be empty, if we raced with mark_host_tlb_stale or Pd::make_current. In this case, we
+    // cannot tell what is stale and flush everything.
+    if (!own_ranges or ranges.full() or ranges.empty()) {
+        Hpt::flush();
+        return;
+    }
+
+    for (mword vaddr : ranges) {
+        Hpt::flush_one_page(reinterpret_cast<void*>(vaddr));
+    }
+}
+
+void Space_mem::discard_stale_host_tlb()
+{
+    stale_host_tlb.clr(Cpu::id());
+
+    Tlb_pending& pending{tlb_pending()};
+    Lock_guard<Spinlock> guard{pending.lock};
+
+    if (pending.space == this) {
+        pending.ranges.clear();
+        pending.space = nullptr;
+    }
+}
+
 void Space_mem::shootdown()
 {
     Bitmap<uint32, NUM_CPU> stale_cpus{false};
@@ -181,9 +262,8 @@ void Space_mem::shootdown()
         // for this CPU to receive it. See the comment at the while loop below.
         tlb_shootdown()[cpu] = Counter::remote_tlb_shootdown(cpu);
 
-        // Set HZD_TLB on the remote core and send an NMI.
-        Atomic::set_mask(Cpu::hazard(cpu), HZD_TLB);
-        stale_cpus[cpu] = Lapic::send_nmi(cpu);
+        // Set HZD_TLB on the remote core and make sure an NMI is on its way.
+        stale_cpus[cpu] = Lapic::kick(cpu, HZD_TLB);
     }
 
     // Wait for NMIs to arrive.
@@ -82,6 +82,16 @@ bool Space_obj::insert_root(Kobject* obj)
     return true;
 }
 
+void Space_obj::populate(mword idx, mword count)
+{
+    mword const caps_per_page{PAGE_SIZE / sizeof(Capability)};
+    bool shootdown;
+
+    for (mword i{idx}; i < idx + count; i = align_dn(i, caps_per_page) + caps_per_page) {
+        walk(i, shootdown);
+    }
+}
+
 void Space_obj::page_fault(mword addr, mword error)
 {
     assert(!(error & Hpt::ERR_W));
@@ -25,11 +25,13 @@
 
 #include "syscall.hpp"
 #include "acpi.hpp"
+#include "cmdline.hpp"
 #include "cpu.hpp"
 #include "hip.hpp"
 #include "kp.hpp"
 #include "lapic.hpp"
 #include "msr.hpp"
+#include "notification.hpp"
 #include "pci.hpp"
 #include "pt.hpp"
 #include "sm.hpp"
@@ -48,6 +50,10 @@ void Ec::sys_finish(Sys_regs::Status status)
 
     current()->regs.set_status(status);
 
+    if (EXPECT_FALSE(current()->multicall_kp)) {
+        multicall_continue();
+    }
+
     ret_user_sysexit();
 }
 
@@ -64,6 +70,10 @@ void Ec::activate()
     for (Sc::ctr_link() = 0; ec->partner; ec = ec->partner)
         Sc::ctr_link()++;
 
+    // Local ECs only run on their own SC, if it is the proxy SC of a cross-CPU call.
+    if (EXPECT_FALSE(ec == this and not glb and Sc::current()->ec == this))
+        serve_remote_calls();
+
     if (EXPECT_FALSE(ec->blocked()))
         ec->block_sc();
 
@@ -127,15 +137,30 @@ void Ec::sys_call()
 
     Ec* ec = pt->ec;
 
-    if (EXPECT_FALSE(current()->cpu != ec->xcpu))
-        sys_finish<Sys_regs::BAD_CPU>();
+    if (EXPECT_FALSE(current()->cpu != ec->xcpu)) {
+        if (ec->glb or s->flags() & Sys_call::DISABLE_BLOCKING)
+            sys_finish<Sys_regs::BAD_CPU>();
+
+        sys_call_remote(pt);
+    }
 
     if (EXPECT_TRUE(!ec->cont)) {
         current()->cont = ret_user_sysexit;
         current()->set_partner(ec);
-        ec->cont = recv_user;
         ec->regs.set_pt(pt->id);
         ec->regs.set_ip(pt->ip);
+
+        Utcb* src = current()->utcb.get();
+
+        // IPC fast path: If there are only untyped words to transfer, we copy them right here and enter the
+        // callee directly instead of going through recv_user.
+        if (EXPECT_TRUE(not Cmdline::noipcfast and not src->tcnt())) {
+            src->save(ec->utcb.get());
+            ec->cont = ret_user_sysexit;
+            ec->return_to_user_sysexit();
+        }
+
+        ec->cont = recv_user;
         ec->return_to_user();
     }
 
@@ -145,6 +170,80 @@ void Ec::sys_call()
     sys_finish<Sys_regs::COM_TIM>();
 }
 
+void Ec::sys_call_remote(Pt* pt)
+{
+    Ec* const self{current()};
+    Ec* const ec{pt->ec};
+
+    self->xcall_id = pt->id;
+    self->xcall_ip = pt->ip;
+    self->cont = ret_user_sysexit;
+    Atomic::store(self->xcall_pending, true);
+
+    // The mailbox holds a reference to the caller until the handler replies. See Ec::reply_remote.
+    bool ok = self->add_ref();
+    assert(ok);
+
+    ec->mailbox.enqueue(self);
+
+    // The proxy SC keeps its own reference until Ec::serve_remote_calls drops it. Enqueueing it kicks the CPU
+    // of the handler. If the handler has enough proxy SCs already, one of them picks up the call.
+    if (ec->xcall_proxies.try_add()) {
+        (new Sc(&Pd::kern, 0, ec, ec->cpu, Sc::current()->prio))->remote_enqueue();
+    }
+
+    self->block_sc();
+
+    // The handler has already replied.
+    self->return_to_user();
+}
+
+void Ec::recv_remote()
+{
+    Ec* const self{current()};
+    Ec* const ec{self->xcalls.head()};
+
+    bool ok = self->xcalls.dequeue(ec);
+    assert(ok);
+
+    // The reference of the mailbox moves to rcap.
+    self->rcap = ec;
+    self->regs.set_pt(ec->xcall_id);
+    self->regs.set_ip(ec->xcall_ip);
+
+    recv_user();
+}
+
+void Ec::serve_remote_calls()
+{
+    assert(cpu == Cpu::id());
+
+    do {
+        mailbox.drain([this](Ec* ec) { xcalls.enqueue(ec); });
+
+        if (EXPECT_FALSE(cont == dead)) {
+            for (Ec* ec; xcalls.dequeue(ec = xcalls.head());) {
+                ec->release_remote(sys_finish<Sys_regs::COM_ABT>);
+
+                if (ec->del_rcu())
+                    Rcu::call(ec);
+            }
+        } else if (cont) {
+            // The handler is busy, so the proxy SC helps it to finish.
+            return;
+        } else if (xcalls.head()) {
+            cont = recv_remote;
+            return;
+        }
+    } while (not xcall_proxies.try_remove([this] { return not mailbox.empty(); }));
+
+    // There are no pending calls left, so this proxy SC is not needed anymore.
+    bool last = Sc::current()->del_ref();
+    assert(not last);
+
+    Sc::schedule(true);
+}
+
 void Ec::recv_kern()
 {
     Ec* ec = current()->rcap;
@@ -190,7 +289,7 @@ void Ec::reply(void (*c)(), Sm* sm)
         Sc::schedule(true);
 
     if (sm)
-        sm->dn(false, ec, clr);
+        sm->dn_kernel(ec, clr);
 
     if (!clr)
         Sc::current()->ec->activate();
@@ -198,6 +297,36 @@ void Ec::reply(void (*c)(), Sm* sm)
     ec->return_to_user();
 }
 
+void Ec::reply_remote(void (*c)(), void (*r)())
+{
+    Ec* const self{current()};
+    Ec* const ec{self->rcap};
+
+    self->cont = c;
+    self->rcap = nullptr;
+
+    ec->release_remote(r);
+
+    if (ec->del_rcu())
+        Rcu::call(ec);
+
+    Sc::current()->ec->activate();
+}
+
+void Ec::reply_fast(Ec* ec)
+{
+    // These are the cases in which Ec::reply schedules or does not return to the caller.
+    if (EXPECT_FALSE(current()->glb or not Sc::ctr_link() or
+                     (Sc::current()->ec == ec and Sc::current()->last_ref()))) {
+        reply();
+    }
+
+    current()->cont = nullptr;
+
+    ec->clr_partner();
+    ec->return_to_user_sysexit();
+}
+
 void Ec::sys_reply()
 {
     Sm* sm = nullptr;
@@ -205,6 +334,30 @@ void Ec::sys_reply()
     if (Ec* ec = current()->rcap; EXPECT_TRUE(ec)) {
 
         Sys_reply* r = static_cast<Sys_reply*>(current()->sys_regs());
+        Utcb* src = current()->utcb.get();
+
+        // The caller of a cross-CPU call waits on another CPU. It cannot block on a reply semaphore there, so
+        // the reply fails and the call stays pending.
+        if (EXPECT_FALSE(ec->cpu != current()->cpu)) {
+            if (EXPECT_FALSE(r->sm())) {
+                trace(TRACE_ERROR, "%s: Reply SM for a cross-CPU call (%#lx)", __func__, r->sm());
+                sys_finish<Sys_regs::BAD_PAR>();
+            }
+
+            if (EXPECT_FALSE(src->tcnt()))
+                delegate<false>().unwrap("Failed to delegate items during reply");
+
+            src->save(ec->utcb.get());
+            reply_remote(nullptr, ret_user_sysexit);
+        }
+
+        // IPC fast path: The caller waits in sys_call and we only send untyped words back.
+        if (EXPECT_TRUE(not Cmdline::noipcfast and not r->sm() and not src->tcnt() and
+                        ec->cont == ret_user_sysexit)) {
+            src->save(ec->utcb.get());
+            reply_fast(ec);
+        }
+
         if (EXPECT_FALSE(r->sm())) {
             sm = capability_cast<Sm>(Space_obj::lookup(r->sm()));
 
@@ -213,8 +366,6 @@ void Ec::sys_reply()
             }
         }
 
-        Utcb* src = current()->utcb.get();
-
         if (EXPECT_FALSE(src->tcnt()))
             delegate<false>().unwrap("Failed to delegate items during reply");
 
@@ -393,7 +544,25 @@ void Ec::sys_create_sm()
         sys_finish<Sys_regs::BAD_CAP>();
     }
 
-    Sm* sm = new Sm(Pd::current(), r->sel(), r->cnt());
+    Kp* kp{nullptr};
+
+    if (r->has_user_counter()) {
+        kp = capability_cast<Kp>(Space_obj::lookup(r->kp()));
+
+        if (EXPECT_FALSE(not kp)) {
+            trace(TRACE_ERROR, "%s: Bad KP CAP (%#lx)", __func__, r->kp());
+            sys_finish<Sys_regs::BAD_CAP>();
+        }
+
+        if (EXPECT_FALSE(r->offset() >= PAGE_SIZE or r->offset() % sizeof(int64) != 0 or
+                         static_cast<int64>(r->cnt()) < 0)) {
+            trace(TRACE_ERROR, "%s: Invalid counter offset (%#lx) or count (%#lx)", __func__, r->offset(),
+                  r->cnt());
+            sys_finish<Sys_regs::BAD_PAR>();
+        }
+    }
+
+    Sm* sm = new Sm(Pd::current(), r->sel(), r->cnt(), kp, r->offset());
 
     if (!Space_obj::insert_root(sm)) {
         trace(TRACE_ERROR, "%s: Non-NULL CAP (%#lx)", __func__, r->sel());
@@ -427,6 +596,93 @@ void Ec::sys_create_kp()
     sys_finish<Sys_regs::SUCCESS>();
 }
 
+void Ec::sys_create_notification()
+{
+    Sys_create_notification* r = static_cast<Sys_create_notification*>(current()->sys_regs());
+
+    trace(TRACE_SYSCALL, "EC:%p SYS_CREATE NOTIFICATION:%#lx", current(), r->sel());
+
+    if (Pd* pd_parent = capability_cast<Pd>(Space_obj::lookup(r->pd()), Pd::PERM_OBJ_CREATION);
+        EXPECT_FALSE(not pd_parent)) {
+        trace(TRACE_ERROR, "%s: Non-PD CAP (%#lx)", __func__, r->pd());
+        sys_finish<Sys_regs::BAD_CAP>();
+    }
+
+    Notification* n{new Notification(Pd::current(), r->sel())};
+
+    if (!Space_obj::insert_root(n)) {
+        trace(TRACE_ERROR, "%s: Non-NULL CAP (%#lx)", __func__, r->sel());
+        delete n;
+        sys_finish<Sys_regs::BAD_CAP>();
+    }
+
+    sys_finish<Sys_regs::SUCCESS>();
+}
+
+// Create objects of one type for consecutive selectors. Returns the number of objects that were created
+// before the first selector that was already in use.
+template <typename T, typename... ARGS> static mword create_objects(mword sel, mword count, ARGS... args)
+{
+    for (mword i{0}; i < count; i++) {
+        T* obj{new T(Pd::current(), sel + i, args...)};
+
+        if (!Space_obj::insert_root(obj)) {
+            trace(TRACE_ERROR, "create_bulk: Non-NULL CAP (%#lx)", sel + i);
+            delete obj;
+            return i;
+        }
+    }
+
+    return count;
+}
+
+void Ec::sys_create_bulk()
+{
+    Sys_create_bulk* r = static_cast<Sys_create_bulk*>(current()->sys_regs());
+
+    trace(TRACE_SYSCALL, "EC:%p SYS_CREATE BULK:%#lx TYPE:%lu COUNT:%lu", current(), r->sel(), r->type(),
+          r->count());
+
+    if (Pd* pd_parent = capability_cast<Pd>(Space_obj::lookup(r->pd()), Pd::PERM_OBJ_CREATION);
+        EXPECT_FALSE(not pd_parent)) {
+        trace(TRACE_ERROR, "%s: Non-PD CAP (%#lx)", __func__, r->pd());
+        sys_finish<Sys_regs::BAD_CAP>();
+    }
+
+    if (EXPECT_FALSE(r->count() == 0 or r->count() > Sys_create_bulk::max_count or
+                     r->sel() + r->count() > Space_obj::caps)) {
+        trace(TRACE_ERROR, "%s: Invalid selector range (%#lx+%lu)", __func__, r->sel(), r->count());
+        sys_finish<Sys_regs::BAD_PAR>();
+    }
+
+    if (EXPECT_FALSE(r->type() > Sys_create_bulk::NOTIFICATION)) {
+        trace(TRACE_ERROR, "%s: Invalid object type (%lu)", __func__, r->type());
+        sys_finish<Sys_regs::BAD_PAR>();
+    }
+
+    mword const sel{r->sel()};
+    mword const count{r->count()};
+    mword created{0};
+
+    Pd::current()->Space_obj::populate(sel, count);
+
+    switch (r->type()) {
+    case Sys_create_bulk::SM:
+        created = create_objects<Sm>(sel, count, r->param());
+        break;
+    case Sys_create_bulk::KP:
+        created = create_objects<Kp>(sel, count);
+        break;
+    case Sys_create_bulk::NOTIFICATION:
+        created = create_objects<Notification>(sel, count);
+        break;
+    }
+
+    r->set_created(created);
+
+    sys_finish(created == count ? Sys_regs::SUCCESS : Sys_regs::BAD_CAP);
+}
+
 void Ec::sys_create_vcpu()
 {
     Sys_create_vcpu* r = static_cast<Sys_create_vcpu*>(current()->sys_regs());
@@ -633,6 +889,79 @@ void Ec::sys_pd_ctrl()
     sys_finish<Sys_regs::BAD_PAR>();
 }
 
+void Ec::sys_delegate_batch()
+{
+    Sys_delegate_batch* s = static_cast<Sys_delegate_batch*>(current()->sys_regs());
+    Utcb* utcb = current()->utcb.get();
+
+    trace(TRACE_SYSCALL, "EC:%p SYS_DELEGATE_BATCH SRC:%#lx DST:%#lx CNT:%lu", current(), s->src_pd(),
+          s->dst_pd(), s->count());
+
+    static_assert(sizeof(Sys_delegate_batch::Entry) % sizeof(mword) == 0);
+    static constexpr mword entry_words{sizeof(Sys_delegate_batch::Entry) / sizeof(mword)};
+
+    if (EXPECT_FALSE(s->count() > Utcb::mr_count() / entry_words)) {
+        trace(TRACE_ERROR, "%s: Too many entries (%lu)", __func__, s->count());
+        sys_finish<Sys_regs::BAD_PAR>();
+    }
+
+    Pd* src_pd = capability_cast<Pd>(Space_obj::lookup(s->src_pd()));
+    Pd* dst_pd = capability_cast<Pd>(Space_obj::lookup(s->dst_pd()));
+
+    if (EXPECT_FALSE(not(src_pd and dst_pd))) {
+        trace(TRACE_ERROR, "%s: Bad PD CAP SRC:%#lx DST:%#lx", __func__, s->src_pd(), s->dst_pd());
+        sys_finish<Sys_regs::BAD_CAP>();
+    }
+
+    // The cleanup object lives in a separate scope, because sys_finish does not return and its destructor
+    // would never free the page tables it collected.
+    {
+        // All operations collect their TLB invalidations here and share a single shootdown at the end.
+        Tlb_cleanup cleanup;
+        bool need_shootdown{false};
+
+        for (mword i{0}; i < s->count(); i++) {
+            auto& entry{reinterpret_cast<Sys_delegate_batch::Entry&>(utcb->mr(i * entry_words))};
+            Sys_regs::Status status{Sys_regs::SUCCESS};
+
+            switch (Sys_delegate_batch::op(entry)) {
+            case Sys_delegate_batch::DELEGATE: {
+                Crd const dst_crd{entry.dst_crd};
+                auto const result{
+                    dst_pd->xfer_item(cleanup, src_pd, dst_crd, dst_crd, Xfer{Crd{entry.crd}, entry.meta})};
+
+                if (result.is_ok()) {
+                    entry.crd = result.unwrap().crd().value();
+                    entry.meta = result.unwrap().metadata();
+                } else {
+                    status = to_syscall_status(result.unwrap_err().error_type);
+                }
+                break;
+            }
+            case Sys_delegate_batch::REVOKE: {
+                Crd const crd{entry.crd};
+
+                dst_pd->rev_crd(cleanup, crd, Sys_delegate_batch::revoke_self(entry));
+                need_shootdown |= crd.type() == Crd::MEM;
+                break;
+            }
+            default:
+                status = Sys_regs::BAD_PAR;
+                break;
+            }
+
+            entry.op_status = status;
+        }
+
+        if (need_shootdown or cleanup.need_tlb_flush()) {
+            Space_mem::shootdown();
+            cleanup.ignore_tlb_flush(); // because it is done.
+        }
+    }
+
+    sys_finish<Sys_regs::SUCCESS>();
+}
+
 void Ec::sys_ec_ctrl()
 {
     Sys_ec_ctrl* r = static_cast<Sys_ec_ctrl*>(current()->sys_regs());
@@ -701,6 +1030,11 @@ void Ec::sys_sm_ctrl()
         break;
 
     case Sys_sm_ctrl::Sm_operation::Down:
+        if (EXPECT_FALSE(r->zc() and sm->has_user_counter())) {
+            trace(TRACE_ERROR, "%s: Zero counter down on a user-space counter", __func__);
+            sys_finish<Sys_regs::BAD_PAR>();
+        }
+
         current()->cont = Ec::sys_finish<Sys_regs::SUCCESS>;
         sm->dn(r->zc());
         break;
@@ -709,6 +1043,256 @@ void Ec::sys_sm_ctrl()
     sys_finish<Sys_regs::SUCCESS>();
 }
 
+void Ec::sys_sm_wait_any()
+{
+    Sys_sm_wait_any* r = static_cast<Sys_sm_wait_any*>(current()->sys_regs());
+    Ec* const self{current()};
+    Utcb* const utcb{self->utcb.get()};
+
+    if (EXPECT_FALSE(r->count() == 0 or r->count() > MAX_SM_WAIT_ANY)) {
+        trace(TRACE_ERROR, "%s: Invalid number of semaphores (%lu)", __func__, r->count());
+        sys_finish<Sys_regs::BAD_PAR>();
+    }
+
+    unsigned const count{static_cast<unsigned>(r->count())};
+    Sm* sms[MAX_SM_WAIT_ANY];
+
+    for (unsigned i{0}; i < count; i++) {
+        sms[i] = capability_cast<Sm>(Space_obj::lookup(utcb->mr(i)), Sm::PERM_DOWN);
+
+        if (EXPECT_FALSE(not sms[i])) {
+            trace(TRACE_ERROR, "%s: Bad SM CAP (%#lx)", __func__, utcb->mr(i));
+            sys_finish<Sys_regs::BAD_CAP>();
+        }
+
+        if (EXPECT_FALSE(sms[i]->has_user_counter())) {
+            trace(TRACE_ERROR, "%s: SM with user-space counter (%#lx)", __func__, utcb->mr(i));
+            sys_finish<Sys_regs::BAD_PAR>();
+        }
+    }
+
+    for (unsigned i{0}; i < count; i++) {
+        if (sms[i]->try_dn()) {
+            utcb->mr(0) = i;
+            sys_finish<Sys_regs::SUCCESS>();
+        }
+    }
+
+    // The semaphores hold on to the waiters until Ec::sys_sm_wait_any_done has removed them again.
+    bool ok = self->add_ref();
+    assert(ok);
+
+    // Until one of the semaphores claims the wakeup, the queued waiters keep the EC blocked. See
+    // Ec::waits_for_any_sm.
+    Atomic::store(self->sm_wait_index, MAX_SM_WAIT_ANY);
+    self->cont = sys_sm_wait_any_done;
+
+    for (unsigned i{0}; i < count; i++) {
+        Sm_waiter& w{self->sm_waiters[i]};
+
+        ok = sms[i]->add_ref();
+        assert(ok);
+
+        w.sm = sms[i];
+        w.ec = self;
+        self->sm_wait_count = i + 1;
+
+        if (sms[i]->enqueue_waiter(&w)) {
+            break;
+        }
+    }
+
+    self->block_sc();
+
+    sys_sm_wait_any_done();
+}
+
+void Ec::sm_wait_any_leave()
+{
+    Ec* const self{current()};
+
+    for (unsigned i{0}; i < self->sm_wait_count; i++) {
+        Sm* const sm{self->sm_waiters[i].sm};
+
+        sm->dequeue_waiter(&self->sm_waiters[i]);
+
+        if (sm->del_rcu())
+            Rcu::call(sm);
+    }
+
+    self->sm_wait_count = 0;
+
+    bool last = self->del_ref();
+    assert(not last);
+}
+
+void Ec::sys_sm_wait_any_done()
+{
+    sm_wait_any_leave();
+
+    current()->utcb->mr(0) = Atomic::load(current()->sm_wait_index);
+    sys_finish<Sys_regs::SUCCESS>();
+}
+
+void Ec::sys_sm_wait_any_revoked()
+{
+    sm_wait_any_leave();
+    sys_finish<Sys_regs::BAD_CAP>();
+}
+
+void Ec::sys_notification_ctrl()
+{
+    Sys_notification_ctrl* r = static_cast<Sys_notification_ctrl*>(current()->sys_regs());
+    Notification* n = capability_cast<Notification>(Space_obj::lookup(r->notification()), 1U << r->op());
+
+    if (EXPECT_FALSE(not n)) {
+        trace(TRACE_ERROR, "%s: Bad NOTIFICATION CAP (%#lx)", __func__, r->notification());
+        sys_finish<Sys_regs::BAD_CAP>();
+    }
+
+    switch (r->op()) {
+
+    case Sys_notification_ctrl::SIGNAL:
+        n->signal(r->bits());
+        break;
+
+    case Sys_notification_ctrl::WAIT:
+        // A waiter that was woken up retries the whole system call.
+        current()->cont = sys_notification_ctrl;
+        r->set_bits(n->wait());
+        break;
+    }
+
+    sys_finish<Sys_regs::SUCCESS>();
+}
+
+// System calls that are allowed in a batch. They all finish via Ec::sys_finish and never block.
+static bool multicall_allowed(Sys_regs* r)
+{
+    switch (r->id()) {
+    case hypercall_id::HC_REVOKE:
+    case hypercall_id::HC_CREATE_PD:
+    case hypercall_id::HC_CREATE_EC:
+    case hypercall_id::HC_CREATE_SC:
+    case hypercall_id::HC_CREATE_PT:
+    case hypercall_id::HC_CREATE_SM:
+    case hypercall_id::HC_CREATE_KP:
+    case hypercall_id::HC_CREATE_VCPU:
+    case hypercall_id::HC_CREATE_NOTIFICATION:
+    case hypercall_id::HC_CREATE_BULK:
+    case hypercall_id::HC_PD_CTRL:
+    case hypercall_id::HC_DELEGATE_BATCH:
+    case hypercall_id::HC_SC_CTRL:
+    case hypercall_id::HC_PT_CTRL:
+    case hypercall_id::HC_KP_CTRL:
+        return true;
+    case hypercall_id::HC_SM_CTRL:
+        return static_cast<Sys_sm_ctrl*>(r)->op() == Sys_sm_ctrl::Sm_operation::Up;
+    case hypercall_id::HC_NOTIFICATION_CTRL:
+        return static_cast<Sys_notification_ctrl*>(r)->op() == Sys_notification_ctrl::SIGNAL;
+    default:
+        return false;
+    }
+}
+
+static Sys_multicall::Entry* multicall_entry(Kp* kp, mword pos)
+{
+    return static_cast<Sys_multicall::Entry*>(kp->data_page()) + pos;
+}
+
+void Ec::sys_multicall()
+{
+    Sys_multicall* r = static_cast<Sys_multicall*>(current()->sys_regs());
+    Ec* const self{current()};
+
+    trace(TRACE_SYSCALL, "EC:%p SYS_MULTICALL KP:%#lx COUNT:%lu", self, r->kp(), r->count());
+
+    Kp* kp = capability_cast<Kp>(Space_obj::lookup(r->kp()));
+
+    if (EXPECT_FALSE(not kp)) {
+        trace(TRACE_ERROR, "%s: Bad KP CAP (%#lx)", __func__, r->kp());
+        sys_finish<Sys_regs::BAD_CAP>();
+    }
+
+    if (EXPECT_FALSE(r->count() > Sys_multicall::max_count)) {
+        trace(TRACE_ERROR, "%s: Too many system calls (%lu)", __func__, r->count());
+        sys_finish<Sys_regs::BAD_PAR>();
+    }
+
+    self->multicall_kp.reset(kp);
+    self->multicall_pos = 0;
+    self->multicall_count = r->count();
+    self->multicall_args[0] = self->regs.ARG_3;
+    self->multicall_args[1] = self->regs.ARG_4;
+    self->multicall_args[2] = self->regs.ARG_5;
+
+    multicall_next();
+}
+
+void Ec::multicall_next()
+{
+    Ec* const self{current()};
+
+    if (self->multicall_pos == self->multicall_count) {
+        multicall_finish();
+    }
+
+    Sys_multicall::Entry const* e{multicall_entry(self->multicall_kp, self->multicall_pos)};
+
+    self->regs.ARG_1 = e->arg[0];
+    self->regs.ARG_2 = e->arg[1];
+    self->regs.ARG_3 = e->arg[2];
+    self->regs.ARG_4 = e->arg[3];
+    self->regs.ARG_5 = e->arg[4];
+
+    // The batch stops at the first system call that might block. User space performs it on its own.
+    if (EXPECT_FALSE(not multicall_allowed(self->sys_regs()))) {
+        multicall_finish();
+    }
+
+    syscall_handler();
+}
+
+void Ec::multicall_continue()
+{
+    Ec* const self{current()};
+    Sys_multicall::Entry* e{multicall_entry(self->multicall_kp, self->multicall_pos)};
+
+    e->arg[0] = self->regs.ARG_1;
+    e->arg[1] = self->regs.ARG_2;
+    e->arg[2] = self->regs.ARG_3;
+    e->arg[3] = self->regs.ARG_4;
+    e->arg[4] = self->regs.ARG_5;
+
+    // The batch also stops at the first system call that fails, because later ones usually depend on it.
+    if (EXPECT_FALSE(self->regs.status() != Sys_regs::SUCCESS)) {
+        multicall_finish();
+    }
+
+    self->multicall_pos++;
+
+    handle_hazards(multicall_next);
+
+    // Continue on a fresh kernel stack.
+    self->cont = multicall_next;
+    self->return_to_user();
+}
+
+void Ec::multicall_finish()
+{
+    Ec* const self{current()};
+    Sys_multicall* r = static_cast<Sys_multicall*>(self->sys_regs());
+
+    self->regs.ARG_3 = self->multicall_args[0];
+    self->regs.ARG_4 = self->multicall_args[1];
+    self->regs.ARG_5 = self->multicall_args[2];
+    r->set_completed(self->multicall_pos);
+
+    self->multicall_kp.reset();
+
+    sys_finish<Sys_regs::SUCCESS>();
+}
+
 void Ec::sys_kp_ctrl_map()
 {
     Sys_kp_ctrl_map* r = static_cast<Sys_kp_ctrl_map*>(current()->sys_regs());
@@ -728,7 +1312,7 @@ void Ec::sys_kp_ctrl_map()
         sys_finish<Sys_regs::BAD_CAP>();
     }
 
-    if (EXPECT_TRUE(kp->add_user_mapping(user_pd, r->dst_addr()))) {
+    if (EXPECT_TRUE(kp->add_user_mapping(user_pd, r->dst_addr(), not r->read_only()))) {
         sys_finish<Sys_regs::SUCCESS>();
     }
 
@@ -783,6 +1367,8 @@ void Ec::sys_machine_ctrl()
         sys_machine_ctrl_suspend();
     case Sys_machine_ctrl::UPDATE_MICROCODE:
         sys_machine_ctrl_update_microcode();
+    case Sys_machine_ctrl::PAGE_CACHE_STATS:
+        sys_machine_ctrl_page_cache_stats();
 
     default:
         sys_finish<Sys_regs::BAD_PAR>();
@@ -829,6 +1415,28 @@ void Ec::sys_machine_ctrl_update_microcode()
     sys_finish<Sys_regs::SUCCESS>();
 }
 
+void Ec::sys_machine_ctrl_page_cache_stats()
+{
+    Sys_machine_ctrl_page_cache_stats* r =
+        static_cast<Sys_machine_ctrl_page_cache_stats*>(current()->sys_regs());
+    trace(TRACE_SYSCALL, "EC:%p, SYS_MACHINE_CTRL_PAGE_CACHE_STATS CPU: %#lx KP: %#lx", current(), r->cpu(),
+          r->kp());
+
+    if (EXPECT_FALSE(not Hip::cpu_online(r->cpu()))) {
+        trace(TRACE_ERROR, "%s: Invalid CPU (%#lx)", __func__, r->cpu());
+        sys_finish<Sys_regs::BAD_CPU>();
+    }
+
+    Kp* kp = capability_cast<Kp>(Space_obj::lookup(r->kp()));
+    if (EXPECT_FALSE(not kp)) {
+        trace(TRACE_ERROR, "%s: Bad KP CAP (%#lx)", __func__, r->kp());
+        sys_finish<Sys_regs::BAD_CAP>();
+    }
+
+    *static_cast<Page_cache_stats*>(kp->data_page()) = Buddy::page_cache_stats(static_cast<unsigned>(r->cpu()));
+    sys_finish<Sys_regs::SUCCESS>();
+}
+
 static Sys_regs::Status to_syscall_status(Vcpu_acquire_error acq_error)
 {
     switch (acq_error.error_type) {
@@ -880,6 +1488,164 @@ void Ec::sys_vcpu_ctrl_poke()
     sys_finish(Sys_regs::SUCCESS);
 }
 
+void Ec::sys_vcpu_ctrl_exit_mtd()
+{
+    Sys_vcpu_ctrl_exit_mtd* r = static_cast<Sys_vcpu_ctrl_exit_mtd*>(current()->sys_regs());
+    trace(TRACE_SYSCALL, "EC:%p, SYS_VCPU_CTRL_EXIT_MTD VCPU: %#lx REASON: %#lx MTD: %#lx", current(), r->sel(),
+          r->exit_reason(), r->mtd().val);
+
+    Vcpu* vcpu = capability_cast<Vcpu>(Space_obj::lookup(r->sel()));
+    if (EXPECT_FALSE(not vcpu)) {
+        trace(TRACE_ERROR, "%s: Bad vCPU CAP (%#lx)", __func__, r->sel());
+        sys_finish(Sys_regs::BAD_CAP);
+    }
+
+    if (EXPECT_FALSE(r->exit_reason() >= NUM_VMI)) {
+        trace(TRACE_ERROR, "%s: Bad exit reason (%#lx)", __func__, r->exit_reason());
+        sys_finish(Sys_regs::BAD_PAR);
+    }
+
+    vcpu->set_exit_mtd(static_cast<unsigned>(r->exit_reason()), r->mtd());
+    sys_finish(Sys_regs::SUCCESS);
+}
+
+void Ec::sys_vcpu_ctrl_load_state()
+{
+    Sys_vcpu_ctrl_load_state* r = static_cast<Sys_vcpu_ctrl_load_state*>(current()->sys_regs());
+    trace(TRACE_SYSCALL, "EC:%p, SYS_VCPU_CTRL_LOAD_STATE VCPU: %#lx MTD: %#lx", current(), r->sel(),
+          r->mtd().val);
+
+    Vcpu* vcpu = capability_cast<Vcpu>(Space_obj::lookup(r->sel()));
+    if (EXPECT_FALSE(not vcpu)) {
+        trace(TRACE_ERROR, "%s: Bad vCPU CAP (%#lx)", __func__, r->sel());
+        sys_finish(Sys_regs::BAD_CAP);
+    }
+
+    auto result{Ec::try_acquire_vcpu(vcpu)};
+
+    if (result.is_err()) {
+        trace(TRACE_ERROR, "Refusing to claim vCPU.");
+        sys_finish(result.map_err([](auto e) { return to_syscall_status(e); }));
+    }
+
+    // Ec::sys_finish releases the vCPU again.
+    if (EXPECT_FALSE(not vcpu->load_state(r->mtd()))) {
+        trace(TRACE_ERROR, "%s: vCPU did not return from a VM exit", __func__);
+        sys_finish(Sys_regs::BAD_PAR);
+    }
+
+    sys_finish(Sys_regs::SUCCESS);
+}
+
+void Ec::sys_vcpu_ctrl_cpuid_table()
+{
+    Sys_vcpu_ctrl_cpuid_table* r = static_cast<Sys_vcpu_ctrl_cpuid_table*>(current()->sys_regs());
+    trace(TRACE_SYSCALL, "EC:%p, SYS_VCPU_CTRL_CPUID_TABLE VCPU: %#lx KP: %#lx%s", current(), r->sel(), r->kp(),
+          r->remove() ? " REMOVE" : "");
+
+    Vcpu* vcpu = capability_cast<Vcpu>(Space_obj::lookup(r->sel()));
+    if (EXPECT_FALSE(not vcpu)) {
+        trace(TRACE_ERROR, "%s: Bad vCPU CAP (%#lx)", __func__, r->sel());
+        sys_finish(Sys_regs::BAD_CAP);
+    }
+
+    Kp* kp = nullptr;
+    if (not r->remove()) {
+        kp = capability_cast<Kp>(Space_obj::lookup(r->kp()));
+
+        if (EXPECT_FALSE(not kp)) {
+            trace(TRACE_ERROR, "%s: Bad KP CAP (%#lx)", __func__, r->kp());
+            sys_finish(Sys_regs::BAD_CAP);
+        }
+    }
+
+    auto result{Ec::try_acquire_vcpu(vcpu)};
+
+    if (result.is_err()) {
+        trace(TRACE_ERROR, "Refusing to claim vCPU.");
+        sys_finish(result.map_err([](auto e) { return to_syscall_status(e); }));
+    }
+
+    // Ec::sys_finish releases the vCPU again.
+    vcpu->set_cpuid_table(kp);
+    sys_finish(Sys_regs::SUCCESS);
+}
+
+void Ec::sys_vcpu_ctrl_msr_table()
+{
+    Sys_vcpu_ctrl_msr_table* r = static_cast<Sys_vcpu_ctrl_msr_table*>(current()->sys_regs());
+    trace(TRACE_SYSCALL, "EC:%p, SYS_VCPU_CTRL_MSR_TABLE VCPU: %#lx KP: %#lx NOTIFICATION: %#lx%s%s", current(),
+          r->sel(), r->kp(), r->notification(), r->has_notification() ? "" : " (unused)",
+          r->remove() ? " REMOVE" : "");
+
+    Vcpu* vcpu = capability_cast<Vcpu>(Space_obj::lookup(r->sel()));
+    if (EXPECT_FALSE(not vcpu)) {
+        trace(TRACE_ERROR, "%s: Bad vCPU CAP (%#lx)", __func__, r->sel());
+        sys_finish(Sys_regs::BAD_CAP);
+    }
+
+    Kp* kp = nullptr;
+    if (not r->remove()) {
+        kp = capability_cast<Kp>(Space_obj::lookup(r->kp()));
+
+        if (EXPECT_FALSE(not kp)) {
+            trace(TRACE_ERROR, "%s: Bad KP CAP (%#lx)", __func__, r->kp());
+            sys_finish(Sys_regs::BAD_CAP);
+        }
+    }
+
+    // The notification is only needed for entries with the notify flag.
+    Notification* n = nullptr;
+    if (not r->remove() and r->has_notification()) {
+        n = capability_cast<Notification>(Space_obj::lookup(r->notification()), Notification::PERM_SIGNAL);
+
+        if (EXPECT_FALSE(not n)) {
+            trace(TRACE_ERROR, "%s: Bad notification CAP (%#lx)", __func__, r->notification());
+            sys_finish(Sys_regs::BAD_CAP);
+        }
+    }
+
+    auto result{Ec::try_acquire_vcpu(vcpu)};
+
+    if (result.is_err()) {
+        trace(TRACE_ERROR, "Refusing to claim vCPU.");
+        sys_finish(result.map_err([](auto e) { return to_syscall_status(e); }));
+    }
+
+    // Ec::sys_finish releases the vCPU again.
+    vcpu->set_msr_table(kp, n);
+    sys_finish(Sys_regs::SUCCESS);
+}
+
+void Ec::sys_vcpu_ctrl_exit_stats()
+{
+    Sys_vcpu_ctrl_exit_stats* r = static_cast<Sys_vcpu_ctrl_exit_stats*>(current()->sys_regs());
+    trace(TRACE_SYSCALL, "EC:%p, SYS_VCPU_CTRL_EXIT_STATS VCPU: %#lx KP: %#lx", current(), r->sel(), r->kp());
+
+    Vcpu* vcpu = capability_cast<Vcpu>(Space_obj::lookup(r->sel()));
+    if (EXPECT_FALSE(not vcpu)) {
+        trace(TRACE_ERROR, "%s: Bad vCPU CAP (%#lx)", __func__, r->sel());
+        sys_finish(Sys_regs::BAD_CAP);
+    }
+
+    Kp* kp = capability_cast<Kp>(Space_obj::lookup(r->kp()));
+    if (EXPECT_FALSE(not kp)) {
+        trace(TRACE_ERROR, "%s: Bad KP CAP (%#lx)", __func__, r->kp());
+        sys_finish(Sys_regs::BAD_CAP);
+    }
+
+    auto result{Ec::try_acquire_vcpu(vcpu)};
+
+    if (result.is_err()) {
+        trace(TRACE_ERROR, "Refusing to claim vCPU.");
+        sys_finish(result.map_err([](auto e) { return to_syscall_status(e); }));
+    }
+
+    // Ec::sys_finish releases the vCPU again.
+    vcpu->set_exit_stats(kp);
+    sys_finish(Sys_regs::SUCCESS);
+}
+
 void Ec::sys_vcpu_ctrl()
 {
     Sys_vcpu_ctrl* r = static_cast<Sys_vcpu_ctrl*>(current()->sys_regs());
@@ -891,6 +1657,21 @@ void Ec::sys_vcpu_ctrl()
     case Sys_vcpu_ctrl::POKE: {
         sys_vcpu_ctrl_poke();
     }
+    case Sys_vcpu_ctrl::EXIT_MTD: {
+        sys_vcpu_ctrl_exit_mtd();
+    }
+    case Sys_vcpu_ctrl::LOAD_STATE: {
+        sys_vcpu_ctrl_load_state();
+    }
+    case Sys_vcpu_ctrl::CPUID_TABLE: {
+        sys_vcpu_ctrl_cpuid_table();
+    }
+    case Sys_vcpu_ctrl::MSR_TABLE: {
+        sys_vcpu_ctrl_msr_table();
+    }
+    case Sys_vcpu_ctrl::EXIT_STATS: {
+        sys_vcpu_ctrl_exit_stats();
+    }
     };
 
     sys_finish<Sys_regs::BAD_PAR>();
@@ -922,9 +1703,15 @@ void Ec::syscall_handler()
         sys_create_kp();
     case hypercall_id::HC_CREATE_VCPU:
         sys_create_vcpu();
+    case hypercall_id::HC_CREATE_NOTIFICATION:
+        sys_create_notification();
+    case hypercall_id::HC_CREATE_BULK:
+        sys_create_bulk();
 
     case hypercall_id::HC_PD_CTRL:
         sys_pd_ctrl();
+    case hypercall_id::HC_DELEGATE_BATCH:
+        sys_delegate_batch();
     case hypercall_id::HC_EC_CTRL:
         sys_ec_ctrl();
     case hypercall_id::HC_SC_CTRL:
@@ -933,6 +1720,12 @@ void Ec::syscall_handler()
         sys_pt_ctrl();
     case hypercall_id::HC_SM_CTRL:
         sys_sm_ctrl();
+    case hypercall_id::HC_SM_WAIT_ANY:
+        sys_sm_wait_any();
+    case hypercall_id::HC_NOTIFICATION_CTRL:
+        sys_notification_ctrl();
+    case hypercall_id::HC_MULTICALL:
+        sys_multicall();
     case hypercall_id::HC_KP_CTRL:
         sys_kp_ctrl();
     case hypercall_id::HC_VCPU_CTRL:
@@ -942,6 +1735,16 @@ void Ec::syscall_handler()
         sys_machine_ctrl();
 
     default:
+#ifdef BENCHMARKS
+        if (EXPECT_FALSE(Cmdline::syscallbench)) {
+            sample_syscall_bench();
+        }
+
+        if (EXPECT_FALSE(Cmdline::ipcbench)) {
+            sample_ipc_bench();
+        }
+#endif
+
         Ec::sys_finish<Sys_regs::BAD_HYP>();
     }
 }
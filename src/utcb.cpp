@@ -119,7 +119,7 @@ bool Utcb::save_exc(Cpu_regs* regs)
     return mtd & Mtd::FPU;
 }
 
-void Utcb::load_vmx(Cpu_regs* regs)
+void Utcb::load_vmx(Cpu_regs* regs, Vmcs_cache& cache)
 {
     mword m = regs->mtd;
 
@@ -150,50 +150,50 @@ void Utcb::load_vmx(Cpu_regs* regs)
     regs->vmcs->make_current();
 
     if (m & Mtd::RSP)
-        rsp = Vmcs::read(Vmcs::GUEST_RSP);
+        rsp = cache.read(Vmcs_cache::RSP);
 
     if (m & Mtd::RIP_LEN) {
-        rip = Vmcs::read(Vmcs::GUEST_RIP);
+        rip = cache.read(Vmcs_cache::RIP);
         inst_len = Vmcs::read(Vmcs::EXI_INST_LEN);
     }
 
     if (m & Mtd::RFLAGS)
-        rflags = Vmcs::read(Vmcs::GUEST_RFLAGS);
+        rflags = cache.read(Vmcs_cache::RFLAGS);
 
     if (m & Mtd::DS_ES) {
-        ds.set_vmx(Vmcs::read(Vmcs::GUEST_SEL_DS), Vmcs::read(Vmcs::GUEST_BASE_DS),
-                   Vmcs::read(Vmcs::GUEST_LIMIT_DS), Vmcs::read(Vmcs::GUEST_AR_DS));
-        es.set_vmx(Vmcs::read(Vmcs::GUEST_SEL_ES), Vmcs::read(Vmcs::GUEST_BASE_ES),
-                   Vmcs::read(Vmcs::GUEST_LIMIT_ES), Vmcs::read(Vmcs::GUEST_AR_ES));
+        ds.set_vmx(cache.read(Vmcs_cache::SEL_DS), cache.read(Vmcs_cache::BASE_DS),
+                   cache.read(Vmcs_cache::LIMIT_DS), cache.read(Vmcs_cache::AR_DS));
+        es.set_vmx(cache.read(Vmcs_cache::SEL_ES), cache.read(Vmcs_cache::BASE_ES),
+                   cache.read(Vmcs_cache::LIMIT_ES), cache.read(Vmcs_cache::AR_ES));
     }
 
     if (m & Mtd::FS_GS) {
-        fs.set_vmx(Vmcs::read(Vmcs::GUEST_SEL_FS), Vmcs::read(Vmcs::GUEST_BASE_FS),
-                   Vmcs::read(Vmcs::GUEST_LIMIT_FS), Vmcs::read(Vmcs::GUEST_AR_FS));
-        gs.set_vmx(Vmcs::read(Vmcs::GUEST_SEL_GS), Vmcs::read(Vmcs::GUEST_BASE_GS),
-                   Vmcs::read(Vmcs::GUEST_LIMIT_GS), Vmcs::read(Vmcs::GUEST_AR_GS));
+        fs.set_vmx(cache.read(Vmcs_cache::SEL_FS), cache.read(Vmcs_cache::BASE_FS),
+                   cache.read(Vmcs_cache::LIMIT_FS), cache.read(Vmcs_cache::AR_FS));
+        gs.set_vmx(cache.read(Vmcs_cache::SEL_GS), cache.read(Vmcs_cache::BASE_GS),
+                   cache.read(Vmcs_cache::LIMIT_GS), cache.read(Vmcs_cache::AR_GS));
     }
 
     if (m & Mtd::CS_SS) {
-        cs.set_vmx(Vmcs::read(Vmcs::GUEST_SEL_CS), Vmcs::read(Vmcs::GUEST_BASE_CS),
-                   Vmcs::read(Vmcs::GUEST_LIMIT_CS), Vmcs::read(Vmcs::GUEST_AR_CS));
-        ss.set_vmx(Vmcs::read(Vmcs::GUEST_SEL_SS), Vmcs::read(Vmcs::GUEST_BASE_SS),
-                   Vmcs::read(Vmcs::GUEST_LIMIT_SS), Vmcs::read(Vmcs::GUEST_AR_SS));
+        cs.set_vmx(cache.read(Vmcs_cache::SEL_CS), cache.read(Vmcs_cache::BASE_CS),
+                   cache.read(Vmcs_cache::LIMIT_CS), cache.read(Vmcs_cache::AR_CS));
+        ss.set_vmx(cache.read(Vmcs_cache::SEL_SS), cache.read(Vmcs_cache::BASE_SS),
+                   cache.read(Vmcs_cache::LIMIT_SS), cache.read(Vmcs_cache::AR_SS));
     }
 
     if (m & Mtd::TR)
-        tr.set_vmx(Vmcs::read(Vmcs::GUEST_SEL_TR), Vmcs::read(Vmcs::GUEST_BASE_TR),
-                   Vmcs::read(Vmcs::GUEST_LIMIT_TR), Vmcs::read(Vmcs::GUEST_AR_TR));
+        tr.set_vmx(cache.read(Vmcs_cache::SEL_TR), cache.read(Vmcs_cache::BASE_TR),
+                   cache.read(Vmcs_cache::LIMIT_TR), cache.read(Vmcs_cache::AR_TR));
 
     if (m & Mtd::LDTR)
-        ld.set_vmx(Vmcs::read(Vmcs::GUEST_SEL_LDTR), Vmcs::read(Vmcs::GUEST_BASE_LDTR),
-                   Vmcs::read(Vmcs::GUEST_LIMIT_LDTR), Vmcs::read(Vmcs::GUEST_AR_LDTR));
+        ld.set_vmx(cache.read(Vmcs_cache::SEL_LDTR), cache.read(Vmcs_cache::BASE_LDTR),
+                   cache.read(Vmcs_cache::LIMIT_LDTR), cache.read(Vmcs_cache::AR_LDTR));
 
     if (m & Mtd::GDTR)
-        gd.set_vmx(0, Vmcs::read(Vmcs::GUEST_BASE_GDTR), Vmcs::read(Vmcs::GUEST_LIMIT_GDTR), 0);
+        gd.set_vmx(0, cache.read(Vmcs_cache::BASE_GDTR), cache.read(Vmcs_cache::LIMIT_GDTR), 0);
 
     if (m & Mtd::IDTR)
-        id.set_vmx(0, Vmcs::read(Vmcs::GUEST_BASE_IDTR), Vmcs::read(Vmcs::GUEST_LIMIT_IDTR), 0);
+        id.set_vmx(0, cache.read(Vmcs_cache::BASE_IDTR), cache.read(Vmcs_cache::LIMIT_IDTR), 0);
 
     if (m & Mtd::CR) {
         cr0 = regs->read_cr<Vmcs>(0);
@@ -205,12 +205,12 @@ void Utcb::load_vmx(Cpu_regs* regs)
     }
 
     if (m & Mtd::DR)
-        dr7 = Vmcs::read(Vmcs::GUEST_DR7);
+        dr7 = cache.read(Vmcs_cache::DR7);
 
     if (m & Mtd::SYSENTER) {
-        sysenter_cs = Vmcs::read(Vmcs::GUEST_SYSENTER_CS);
-        sysenter_rsp = Vmcs::read(Vmcs::GUEST_SYSENTER_ESP);
-        sysenter_rip = Vmcs::read(Vmcs::GUEST_SYSENTER_EIP);
+        sysenter_cs = cache.read(Vmcs_cache::SYSENTER_CS);
+        sysenter_rsp = cache.read(Vmcs_cache::SYSENTER_ESP);
+        sysenter_rip = cache.read(Vmcs_cache::SYSENTER_EIP);
     }
 
     if (m & Mtd::QUAL) {
@@ -231,15 +231,15 @@ void Utcb::load_vmx(Cpu_regs* regs)
     }
 
     if (m & Mtd::STA) {
-        intr_state = static_cast<uint32>(Vmcs::read(Vmcs::GUEST_INTR_STATE));
-        actv_state = static_cast<uint32>(Vmcs::read(Vmcs::GUEST_ACTV_STATE));
+        intr_state = static_cast<uint32>(cache.read(Vmcs_cache::INTR_STATE));
+        actv_state = static_cast<uint32>(cache.read(Vmcs_cache::ACTV_STATE));
     }
 
     if (m & Mtd::TSC) {
         tsc_val = rdtsc();
-        tsc_off = Vmcs::read(Vmcs::TSC_OFFSET);
+        tsc_off = cache.read(Vmcs_cache::TSC_OFFSET);
 
-        mword guest_msr_area_phys = Vmcs::read(Vmcs::EXI_MSR_ST_ADDR);
+        mword guest_msr_area_phys = cache.read(Vmcs_cache::EXI_MSR_ST_ADDR);
         Msr_area* guest_msr_area = reinterpret_cast<Msr_area*>(Buddy::phys_to_ptr(guest_msr_area_phys));
         tsc_aux = static_cast<uint32>(guest_msr_area->ia32_tsc_aux.msr_data);
     }
@@ -250,11 +250,11 @@ void Utcb::load_vmx(Cpu_regs* regs)
 
     if (m & Mtd::EFER_PAT) {
         efer = Vmcs::read(Vmcs::GUEST_EFER);
-        pat = Vmcs::read(Vmcs::GUEST_PAT);
+        pat = cache.read(Vmcs_cache::PAT);
     }
 
     if (m & Mtd::SYSCALL_SWAPGS) {
-        mword guest_msr_area_phys = Vmcs::read(Vmcs::EXI_MSR_ST_ADDR);
+        mword guest_msr_area_phys = cache.read(Vmcs_cache::EXI_MSR_ST_ADDR);
         Msr_area* guest_msr_area = reinterpret_cast<Msr_area*>(Buddy::phys_to_ptr(guest_msr_area_phys));
         star = guest_msr_area->ia32_star.msr_data;
         lstar = guest_msr_area->ia32_lstar.msr_data;
@@ -263,25 +263,25 @@ void Utcb::load_vmx(Cpu_regs* regs)
     }
 
     if (m & Mtd::PDPTE) {
-        pdpte[0] = Vmcs::read(Vmcs::GUEST_PDPTE0);
-        pdpte[1] = Vmcs::read(Vmcs::GUEST_PDPTE1);
-        pdpte[2] = Vmcs::read(Vmcs::GUEST_PDPTE2);
-        pdpte[3] = Vmcs::read(Vmcs::GUEST_PDPTE3);
+        pdpte[0] = cache.read(Vmcs_cache::PDPTE0);
+        pdpte[1] = cache.read(Vmcs_cache::PDPTE1);
+        pdpte[2] = cache.read(Vmcs_cache::PDPTE2);
+        pdpte[3] = cache.read(Vmcs_cache::PDPTE3);
     }
 
     if (m & Mtd::TPR) {
-        tpr_threshold = static_cast<uint32>(Vmcs::read(Vmcs::TPR_THRESHOLD));
+        tpr_threshold = static_cast<uint32>(cache.read(Vmcs_cache::TPR_THRESHOLD));
     }
 
     if (m & Mtd::EOI) {
-        eoi_bitmap[0] = Vmcs::read(Vmcs::EOI_EXIT_BITMAP_0);
-        eoi_bitmap[1] = Vmcs::read(Vmcs::EOI_EXIT_BITMAP_1);
-        eoi_bitmap[2] = Vmcs::read(Vmcs::EOI_EXIT_BITMAP_2);
-        eoi_bitmap[3] = Vmcs::read(Vmcs::EOI_EXIT_BITMAP_3);
+        eoi_bitmap[0] = cache.read(Vmcs_cache::EOI_EXIT_BITMAP_0);
+        eoi_bitmap[1] = cache.read(Vmcs_cache::EOI_EXIT_BITMAP_1);
+        eoi_bitmap[2] = cache.read(Vmcs_cache::EOI_EXIT_BITMAP_2);
+        eoi_bitmap[3] = cache.read(Vmcs_cache::EOI_EXIT_BITMAP_3);
     }
 
     if (m & Mtd::VINTR) {
-        vintr_status = static_cast<uint16>(Vmcs::read(Vmcs::GUEST_INTR_STS));
+        vintr_status = static_cast<uint16>(cache.read(Vmcs_cache::INTR_STS));
     }
 
     barrier();
@@ -289,7 +289,7 @@ void Utcb::load_vmx(Cpu_regs* regs)
     items = sizeof(Utcb_data) / sizeof(mword);
 }
 
-void Utcb::save_vmx(Cpu_regs* regs, const bool passthrough_vcpu)
+void Utcb::save_vmx(Cpu_regs* regs, Vmcs_cache& cache, const bool passthrough_vcpu)
 {
     if (mtd == 0) {
         return;
@@ -322,71 +322,71 @@ void Utcb::save_vmx(Cpu_regs* regs, const bool passthrough_vcpu)
     regs->vmcs->make_current();
 
     if (mtd & Mtd::RSP)
-        Vmcs::write(Vmcs::GUEST_RSP, rsp);
+        cache.write(Vmcs_cache::RSP, rsp);
 
     if (mtd & Mtd::RIP_LEN) {
-        Vmcs::write(Vmcs::GUEST_RIP, rip);
+        cache.write(Vmcs_cache::RIP, rip);
         Vmcs::write(Vmcs::ENT_INST_LEN, inst_len);
     }
 
     if (mtd & Mtd::RFLAGS)
-        Vmcs::write(Vmcs::GUEST_RFLAGS, rflags);
+        cache.write(Vmcs_cache::RFLAGS, rflags);
 
     if (mtd & Mtd::DS_ES) {
-        Vmcs::write(Vmcs::GUEST_SEL_DS, ds.sel);
-        Vmcs::write(Vmcs::GUEST_BASE_DS, static_cast<mword>(ds.base));
-        Vmcs::write(Vmcs::GUEST_LIMIT_DS, ds.limit);
-        Vmcs::write(Vmcs::GUEST_AR_DS, (ds.ar << 4 & 0x1f000) | (ds.ar & 0xff));
-        Vmcs::write(Vmcs::GUEST_SEL_ES, es.sel);
-        Vmcs::write(Vmcs::GUEST_BASE_ES, static_cast<mword>(es.base));
-        Vmcs::write(Vmcs::GUEST_LIMIT_ES, es.limit);
-        Vmcs::write(Vmcs::GUEST_AR_ES, (es.ar << 4 & 0x1f000) | (es.ar & 0xff));
+        cache.write(Vmcs_cache::SEL_DS, ds.sel);
+        cache.write(Vmcs_cache::BASE_DS, static_cast<mword>(ds.base));
+        cache.write(Vmcs_cache::LIMIT_DS, ds.limit);
+        cache.write(Vmcs_cache::AR_DS, (ds.ar << 4 & 0x1f000) | (ds.ar & 0xff));
+        cache.write(Vmcs_cache::SEL_ES, es.sel);
+        cache.write(Vmcs_cache::BASE_ES, static_cast<mword>(es.base));
+        cache.write(Vmcs_cache::LIMIT_ES, es.limit);
+        cache.write(Vmcs_cache::AR_ES, (es.ar << 4 & 0x1f000) | (es.ar & 0xff));
     }
 
     if (mtd & Mtd::FS_GS) {
-        Vmcs::write(Vmcs::GUEST_SEL_FS, fs.sel);
-        Vmcs::write(Vmcs::GUEST_BASE_FS, static_cast<mword>(fs.base));
-        Vmcs::write(Vmcs::GUEST_LIMIT_FS, fs.limit);
-        Vmcs::write(Vmcs::GUEST_AR_FS, (fs.ar << 4 & 0x1f000) | (fs.ar & 0xff));
-        Vmcs::write(Vmcs::GUEST_SEL_GS, gs.sel);
-        Vmcs::write(Vmcs::GUEST_BASE_GS, static_cast<mword>(gs.base));
-        Vmcs::write(Vmcs::GUEST_LIMIT_GS, gs.limit);
-        Vmcs::write(Vmcs::GUEST_AR_GS, (gs.ar << 4 & 0x1f000) | (gs.ar & 0xff));
+        cache.write(Vmcs_cache::SEL_FS, fs.sel);
+        cache.write(Vmcs_cache::BASE_FS, static_cast<mword>(fs.base));
+        cache.write(Vmcs_cache::LIMIT_FS, fs.limit);
+        cache.write(Vmcs_cache::AR_FS, (fs.ar << 4 & 0x1f000) | (fs.ar & 0xff));
+        cache.write(Vmcs_cache::SEL_GS, gs.sel);
+        cache.write(Vmcs_cache::BASE_GS, static_cast<mword>(gs.base));
+        cache.write(Vmcs_cache::LIMIT_GS, gs.limit);
+        cache.write(Vmcs_cache::AR_GS, (gs.ar << 4 & 0x1f000) | (gs.ar & 0xff));
     }
 
     if (mtd & Mtd::CS_SS) {
-        Vmcs::write(Vmcs::GUEST_SEL_CS, cs.sel);
-        Vmcs::write(Vmcs::GUEST_BASE_CS, static_cast<mword>(cs.base));
-        Vmcs::write(Vmcs::GUEST_LIMIT_CS, cs.limit);
-        Vmcs::write(Vmcs::GUEST_AR_CS, (cs.ar << 4 & 0x1f000) | (cs.ar & 0xff));
-        Vmcs::write(Vmcs::GUEST_SEL_SS, ss.sel);
-        Vmcs::write(Vmcs::GUEST_BASE_SS, static_cast<mword>(ss.base));
-        Vmcs::write(Vmcs::GUEST_LIMIT_SS, ss.limit);
-        Vmcs::write(Vmcs::GUEST_AR_SS, (ss.ar << 4 & 0x1f000) | (ss.ar & 0xff));
+        cache.write(Vmcs_cache::SEL_CS, cs.sel);
+        cache.write(Vmcs_cache::BASE_CS, static_cast<mword>(cs.base));
+        cache.write(Vmcs_cache::LIMIT_CS, cs.limit);
+        cache.write(Vmcs_cache::AR_CS, (cs.ar << 4 & 0x1f000) | (cs.ar & 0xff));
+        cache.write(Vmcs_cache::SEL_SS, ss.sel);
+        cache.write(Vmcs_cache::BASE_SS, static_cast<mword>(ss.base));
+        cache.write(Vmcs_cache::LIMIT_SS, ss.limit);
+        cache.write(Vmcs_cache::AR_SS, (ss.ar << 4 & 0x1f000) | (ss.ar & 0xff));
     }
 
     if (mtd & Mtd::TR) {
-        Vmcs::write(Vmcs::GUEST_SEL_TR, tr.sel);
-        Vmcs::write(Vmcs::GUEST_BASE_TR, static_cast<mword>(tr.base));
-        Vmcs::write(Vmcs::GUEST_LIMIT_TR, tr.limit);
-        Vmcs::write(Vmcs::GUEST_AR_TR, (tr.ar << 4 & 0x1f000) | (tr.ar & 0xff));
+        cache.write(Vmcs_cache::SEL_TR, tr.sel);
+        cache.write(Vmcs_cache::BASE_TR, static_cast<mword>(tr.base));
+        cache.write(Vmcs_cache::LIMIT_TR, tr.limit);
+        cache.write(Vmcs_cache::AR_TR, (tr.ar << 4 & 0x1f000) | (tr.ar & 0xff));
     }
 
     if (mtd & Mtd::LDTR) {
-        Vmcs::write(Vmcs::GUEST_SEL_LDTR, ld.sel);
-        Vmcs::write(Vmcs::GUEST_BASE_LDTR, static_cast<mword>(ld.base));
-        Vmcs::write(Vmcs::GUEST_LIMIT_LDTR, ld.limit);
-        Vmcs::write(Vmcs::GUEST_AR_LDTR, (ld.ar << 4 & 0x1f000) | (ld.ar & 0xff));
+        cache.write(Vmcs_cache::SEL_LDTR, ld.sel);
+        cache.write(Vmcs_cache::BASE_LDTR, static_cast<mword>(ld.base));
+        cache.write(Vmcs_cache::LIMIT_LDTR, ld.limit);
+        cache.write(Vmcs_cache::AR_LDTR, (ld.ar << 4 & 0x1f000) | (ld.ar & 0xff));
     }
 
     if (mtd & Mtd::GDTR) {
-        Vmcs::write(Vmcs::GUEST_BASE_GDTR, static_cast<mword>(gd.base));
-        Vmcs::write(Vmcs::GUEST_LIMIT_GDTR, gd.limit);
+        cache.write(Vmcs_cache::BASE_GDTR, static_cast<mword>(gd.base));
+        cache.write(Vmcs_cache::LIMIT_GDTR, gd.limit);
     }
 
     if (mtd & Mtd::IDTR) {
-        Vmcs::write(Vmcs::GUEST_BASE_IDTR, static_cast<mword>(id.base));
-        Vmcs::write(Vmcs::GUEST_LIMIT_IDTR, id.limit);
+        cache.write(Vmcs_cache::BASE_IDTR, static_cast<mword>(id.base));
+        cache.write(Vmcs_cache::LIMIT_IDTR, id.limit);
     }
 
     if (mtd & Mtd::CR) {
@@ -399,12 +399,12 @@ void Utcb::save_vmx(Cpu_regs* regs, const bool passthrough_vcpu)
     }
 
     if (mtd & Mtd::DR)
-        Vmcs::write(Vmcs::GUEST_DR7, dr7);
+        cache.write(Vmcs_cache::DR7, dr7);
 
     if (mtd & Mtd::SYSENTER) {
-        Vmcs::write(Vmcs::GUEST_SYSENTER_CS, sysenter_cs);
-        Vmcs::write(Vmcs::GUEST_SYSENTER_ESP, sysenter_rsp);
-        Vmcs::write(Vmcs::GUEST_SYSENTER_EIP, sysenter_rip);
+        cache.write(Vmcs_cache::SYSENTER_CS, sysenter_cs);
+        cache.write(Vmcs_cache::SYSENTER_ESP, sysenter_rsp);
+        cache.write(Vmcs_cache::SYSENTER_EIP, sysenter_rip);
     }
 
     if (mtd & Mtd::CTRL) {
@@ -438,14 +438,14 @@ void Utcb::save_vmx(Cpu_regs* regs, const bool passthrough_vcpu)
     }
 
     if (mtd & Mtd::STA) {
-        Vmcs::write(Vmcs::GUEST_INTR_STATE, intr_state);
-        Vmcs::write(Vmcs::GUEST_ACTV_STATE, actv_state);
+        cache.write(Vmcs_cache::INTR_STATE, intr_state);
+        cache.write(Vmcs_cache::ACTV_STATE, actv_state);
     }
 
     if (mtd & Mtd::TSC) {
-        Vmcs::write(Vmcs::TSC_OFFSET, tsc_off);
+        cache.write(Vmcs_cache::TSC_OFFSET, tsc_off);
 
-        mword guest_msr_area_phys = Vmcs::read(Vmcs::EXI_MSR_ST_ADDR);
+        mword guest_msr_area_phys = cache.read(Vmcs_cache::EXI_MSR_ST_ADDR);
         Msr_area* guest_msr_area = reinterpret_cast<Msr_area*>(Buddy::phys_to_ptr(guest_msr_area_phys));
         guest_msr_area->ia32_tsc_aux.msr_data = tsc_aux;
     }
@@ -456,11 +456,11 @@ void Utcb::save_vmx(Cpu_regs* regs, const bool passthrough_vcpu)
 
     if (mtd & Mtd::EFER_PAT) {
         regs->write_efer<Vmcs>(efer);
-        Vmcs::write(Vmcs::GUEST_PAT, pat);
+        cache.write(Vmcs_cache::PAT, pat);
     }
 
     if (mtd & Mtd::SYSCALL_SWAPGS) {
-        mword guest_msr_area_phys = Vmcs::read(Vmcs::EXI_MSR_ST_ADDR);
+        mword guest_msr_area_phys = cache.read(Vmcs_cache::EXI_MSR_ST_ADDR);
         Msr_area* guest_msr_area = reinterpret_cast<Msr_area*>(Buddy::phys_to_ptr(guest_msr_area_phys));
         guest_msr_area->ia32_star.msr_data = star;
         guest_msr_area->ia32_lstar.msr_data = lstar;
@@ -469,10 +469,10 @@ void Utcb::save_vmx(Cpu_regs* regs, const bool passthrough_vcpu)
     }
 
     if (mtd & Mtd::PDPTE) {
-        Vmcs::write(Vmcs::GUEST_PDPTE0, pdpte[0]);
-        Vmcs::write(Vmcs::GUEST_PDPTE1, pdpte[1]);
-        Vmcs::write(Vmcs::GUEST_PDPTE2, pdpte[2]);
-        Vmcs::write(Vmcs::GUEST_PDPTE3, pdpte[3]);
+        cache.write(Vmcs_cache::PDPTE0, pdpte[0]);
+        cache.write(Vmcs_cache::PDPTE1, pdpte[1]);
+        cache.write(Vmcs_cache::PDPTE2, pdpte[2]);
+        cache.write(Vmcs_cache::PDPTE3, pdpte[3]);
     }
 
     if (mtd & Mtd::TLB) {
@@ -480,17 +480,17 @@ void Utcb::save_vmx(Cpu_regs* regs, const bool passthrough_vcpu)
     }
 
     if (mtd & Mtd::TPR) {
-        Vmcs::write(Vmcs::TPR_THRESHOLD, tpr_threshold);
+        cache.write(Vmcs_cache::TPR_THRESHOLD, tpr_threshold);
     }
 
     if (mtd & Mtd::EOI) {
-        Vmcs::write(Vmcs::EOI_EXIT_BITMAP_0, eoi_bitmap[0]);
-        Vmcs::write(Vmcs::EOI_EXIT_BITMAP_1, eoi_bitmap[1]);
-        Vmcs::write(Vmcs::EOI_EXIT_BITMAP_2, eoi_bitmap[2]);
-        Vmcs::write(Vmcs::EOI_EXIT_BITMAP_3, eoi_bitmap[3]);
+        cache.write(Vmcs_cache::EOI_EXIT_BITMAP_0, eoi_bitmap[0]);
+        cache.write(Vmcs_cache::EOI_EXIT_BITMAP_1, eoi_bitmap[1]);
+        cache.write(Vmcs_cache::EOI_EXIT_BITMAP_2, eoi_bitmap[2]);
+        cache.write(Vmcs_cache::EOI_EXIT_BITMAP_3, eoi_bitmap[3]);
     }
 
     if (mtd & Mtd::VINTR) {
-        Vmcs::write(Vmcs::GUEST_INTR_STS, vintr_status);
+        cache.write(Vmcs_cache::INTR_STS, vintr_status);
     }
 }
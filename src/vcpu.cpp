@@ -23,6 +23,7 @@
 #include "ec.hpp"
 #include "hip.hpp"
 #include "lapic.hpp"
+#include "notification.hpp"
 #include "space_obj.hpp"
 #include "stdio.hpp"
 #include "vmx_preemption_timer.hpp"
@@ -33,7 +34,7 @@ Slab_cache Vcpu::cache(sizeof(Vcpu), 32);
 Vcpu::Vcpu(const Vcpu_init_config& init_cfg)
     : Typed_kobject(static_cast<Space_obj*>(init_cfg.owner_pd), init_cfg.cap_selector, Vcpu::PERM_ALL, free),
       pd(init_cfg.owner_pd), kp_vcpu_state(init_cfg.kp_vcpu_state), kp_vlapic_page(init_cfg.kp_vlapic_page),
-      kp_fpu_state(init_cfg.kp_fpu_state), cpu_id(init_cfg.cpu), fpu(kp_fpu_state.get()),
+      kp_fpu_state(init_cfg.kp_fpu_state), cpu_id(init_cfg.cpu), fpu(kp_fpu_state.get(), Fpu::Format::STANDARD),
       passthrough_vcpu(pd->is_passthrough)
 {
     assert(Hip::feature() & Hip::FEAT_VMX);
@@ -110,6 +111,14 @@ Vcpu::Vcpu(const Vcpu_init_config& init_cfg)
         for (auto msr : passthrough_guest_accessible_msrs) {
             msr_bitmap->set_exit(msr, Vmx_msr_bitmap::exit_setting::EXIT_NEVER);
         }
+
+        // In x2APIC mode, the control VM drives the LAPIC via MSRs instead of the LAPIC MMIO page.
+        if (Lapic::x2apic) {
+            for (unsigned msr{Msr::IA32_EXT_XAPIC}; msr <= Msr::IA32_EXT_XAPIC_END; msr++) {
+                msr_bitmap->set_exit(static_cast<Msr::Register>(msr),
+                                     Vmx_msr_bitmap::exit_setting::EXIT_NEVER);
+            }
+        }
     }
 
     Vmcs::write(Vmcs::MSR_BITMAP, msr_bitmap->phys_addr());
@@ -128,9 +137,17 @@ Vcpu::Vcpu(const Vcpu_init_config& init_cfg)
     // function, as it will throw an assertion if we don't set the vmcs member. See hedron#252.
     regs.nst_ctrl<Vmcs>(passthrough_vcpu);
 
+    // By default, the VMM gets the whole state on every VM exit.
+    for (auto& m : exit_mtd) {
+        m = ~0U;
+    }
+
     vmcs->clear();
 }
 
+// The destructor is defined here, because the header only has a forward declaration of Notification.
+Vcpu::~Vcpu() = default;
+
 void Vcpu::init()
 {
     mword* dr = Vcpu::host_dr();
@@ -168,6 +185,66 @@ void Vcpu::mtd(Mtd mtd)
     regs.mtd |= mtd.val;
 }
 
+void Vcpu::set_exit_mtd(unsigned basic_exit_reason, Mtd mtd)
+{
+    assert(basic_exit_reason < NUM_VMI);
+    Atomic::store(exit_mtd[basic_exit_reason], static_cast<uint32>(mtd.val));
+}
+
+bool Vcpu::load_state(Mtd mtd)
+{
+    assert(Atomic::load(owner) == Ec::current());
+
+    // Without a VM exit, the VMCS is stale and we would clobber the state page. See Vcpu::return_to_vmm.
+    if (not has_exit_state) {
+        return false;
+    }
+
+    // The VMCS holds the guest state of the last VM exit until we enter the vCPU again. Modifications of the
+    // VMM only reach the VMCS with the next Vcpu::run, so they are overwritten in the state page.
+    transfer_state(mtd);
+    return true;
+}
+
+void Vcpu::set_cpuid_table(Kp* kp)
+{
+    assert(Atomic::load(owner) == Ec::current());
+    kp_cpuid_table.reset(kp);
+}
+
+void Vcpu::set_msr_table(Kp* kp, Notification* notification)
+{
+    assert(Atomic::load(owner) == Ec::current());
+    kp_msr_table.reset(kp);
+    msr_notification.reset(notification);
+}
+
+void Vcpu::set_exit_stats(Kp* kp)
+{
+    assert(Atomic::load(owner) == Ec::current());
+
+    memset(kp->data_page(), 0, PAGE_SIZE);
+    kp_exit_stats.reset(kp);
+
+    // The VMM owns the vCPU while it sets up the statistics.
+    tsc_mark = rdtsc();
+    in_vmm = true;
+}
+
+void Vcpu::account_tsc(uint64 Vcpu_exit_stats::*counter)
+{
+    Vcpu_exit_stats* stats{exit_stats()};
+
+    if (not stats) {
+        return;
+    }
+
+    const uint64 now{rdtsc()};
+
+    stats->*counter += now - tsc_mark;
+    tsc_mark = now;
+}
+
 void Vcpu::load_dr()
 {
     mword const* const host_dr = Vcpu::host_dr();
@@ -244,6 +321,9 @@ void Vcpu::run()
     // Only the owner of a vCPU is allowed to run it. This check must always come first in this function!
     assert(Atomic::load(owner) == Ec::current());
 
+    account_tsc(in_vmm ? &Vcpu_exit_stats::tsc_vmm : &Vcpu_exit_stats::tsc_kernel);
+    in_vmm = false;
+
     vmcs->make_current();
 
     // When the host received an NMI we give them to the next passthrough vCPU that runs.
@@ -271,6 +351,8 @@ void Vcpu::run()
     Ec::handle_hazards(Ec::resume_vcpu);
 
     exit_reason_shadow = Optional<uint32>{};
+    regs.dst_portal = 0;
+    has_exit_state = false;
     has_pending_mtf_trap = false;
 
     if (EXPECT_FALSE(Atomic::load(poked))) {
@@ -307,7 +389,7 @@ void Vcpu::run()
 
     // This a workaround until hedron#252 is resolved.
     utcb()->mtd = regs.mtd;
-    utcb()->save_vmx(&regs, passthrough_vcpu);
+    utcb()->save_vmx(&regs, vmcs_cache, passthrough_vcpu);
     regs.mtd = 0;
     utcb()->mtd = 0;
 
@@ -365,6 +447,8 @@ void Vcpu::run()
         Msr::write_safe(Msr::IA32_SPEC_CTRL, regs.spec_ctrl);
     }
 
+    account_tsc(&Vcpu_exit_stats::tsc_kernel);
+
     // clang-format off
     asm volatile ("lea %[regs], %%rsp;"
                   EXPAND (LOAD_GPR)
@@ -395,8 +479,17 @@ void Vcpu::handle_vmx()
     // As a precaution we check whether it is really the vCPUs owner that is currently executing.
     assert(Atomic::load(owner) == Ec::current());
 
+    account_tsc(&Vcpu_exit_stats::tsc_guest);
+
     // Unblock NMIs if we blocked them due to entering the vCPU in wait for SIPI state.
-    Atomic::store(Cpu::might_lose_nmis(), false);
+    if (EXPECT_FALSE(Atomic::load(Cpu::might_lose_nmis()))) {
+        Atomic::store(Cpu::might_lose_nmis(), false);
+
+        // An NMI that was sent to us while we were in wait for SIPI state may have been lost. We acknowledge
+        // it here as if it had arrived, because we check hazards before we return to user space or the
+        // guest. Otherwise, other CPUs would suppress further NMIs or wait for one that never arrives.
+        Ec::do_early_nmi_work();
+    }
 
     // To defend against Spectre v2 other kernels would stuff the return stack buffer (RSB) here to avoid the
     // guest injecting branch targets. This is not necessary for us, because we start from a fresh stack and
@@ -432,8 +525,18 @@ void Vcpu::handle_vmx()
 
     save_dr();
 
+    // The guest may have modified its state while it was running. If the VM entry failed, the guest did not
+    // run and the cached guest state is still accurate.
+    if (EXPECT_TRUE(not(exit_reason() & Vmcs::VMX_ENTRY_FAILURE))) {
+        vmcs_cache.invalidate_guest_state();
+    }
+
     uint16 basic_exit_reason{static_cast<uint16>(exit_reason() & 0xffff)};
 
+    if (Vcpu_exit_stats* stats{exit_stats()}; stats and basic_exit_reason < NUM_VMI) {
+        stats->exits[basic_exit_reason]++;
+    }
+
     if (EXPECT_FALSE(has_pending_mtf_trap)
         // If userspace had MTF enabled, we should not hide the exit from it.
         and ((utcb()->ctrl[0] & Vmcs::Ctrl0::CPU_MTF) == 0)) {
@@ -443,6 +546,7 @@ void Vcpu::handle_vmx()
         // to hide our MTF exit, because it is an implementation detail of how poke currently works.
         if (basic_exit_reason == Vmcs::VMX_MTF) {
             synthesize_poked_exit();
+            count(&Vcpu_exit_stats::mtf_poked_exits);
         }
     }
     has_pending_mtf_trap = false;
@@ -462,6 +566,24 @@ void Vcpu::handle_vmx()
         utcb()->actv_state = 3; // wait for SIPI state.
         regs.mtd |= Mtd::STA;
         continue_running();
+    case Vmcs::VMX_CPUID:
+        if (emulate_cpuid()) {
+            count(&Vcpu_exit_stats::cpuid_in_kernel);
+            continue_running();
+        }
+        break;
+    case Vmcs::VMX_RDMSR:
+        if (emulate_rdmsr()) {
+            count(&Vcpu_exit_stats::rdmsr_in_kernel);
+            continue_running();
+        }
+        break;
+    case Vmcs::VMX_WRMSR:
+        if (emulate_wrmsr()) {
+            count(&Vcpu_exit_stats::wrmsr_in_kernel);
+            continue_running();
+        }
+        break;
     case Vmcs::VMX_PREEMPT:
         // Whenever a preemption timer exit occurs we set the value to the
         // maximum possible. This allows to always keep the preemption
@@ -525,6 +647,7 @@ void Vcpu::handle_exception()
             // We don't want to give the NMI exit reason to userspace.
             synthesize_poked_exit();
         } else {
+            count(&Vcpu_exit_stats::nmi_reentries);
             continue_running();
         }
     }
@@ -532,6 +655,98 @@ void Vcpu::handle_exception()
     return_to_vmm(Sys_regs::SUCCESS);
 }
 
+bool Vcpu::emulate_cpuid()
+{
+    if (not kp_cpuid_table or is_single_stepping()) {
+        return false;
+    }
+
+    Cpuid_entry result;
+    const Cpuid_table table{kp_cpuid_table->data_page()};
+
+    if (not table.lookup(static_cast<uint32>(regs.rax), static_cast<uint32>(regs.rcx), result)) {
+        return false;
+    }
+
+    // CPUID clears the upper halves of the 64-bit registers.
+    regs.rax = result.eax;
+    regs.rbx = result.ebx;
+    regs.rcx = result.ecx;
+    regs.rdx = result.edx;
+
+    skip_instruction();
+    return true;
+}
+
+bool Vcpu::emulate_rdmsr()
+{
+    if (not kp_msr_table or is_single_stepping()) {
+        return false;
+    }
+
+    uint64 value;
+    const Msr_table table{kp_msr_table->data_page()};
+
+    if (not table.read(static_cast<uint32>(regs.rcx), value)) {
+        return false;
+    }
+
+    regs.rax = static_cast<uint32>(value);
+    regs.rdx = static_cast<uint32>(value >> 32);
+
+    skip_instruction();
+    return true;
+}
+
+bool Vcpu::emulate_wrmsr()
+{
+    if (not kp_msr_table or is_single_stepping()) {
+        return false;
+    }
+
+    const uint64 value{static_cast<uint64>(static_cast<uint32>(regs.rdx)) << 32 | static_cast<uint32>(regs.rax)};
+    const Msr_table table{kp_msr_table->data_page()};
+    uint64 notify_bits;
+
+    if (not table.write(static_cast<uint32>(regs.rcx), value, notify_bits)) {
+        return false;
+    }
+
+    if (notify_bits and msr_notification) {
+        msr_notification->signal(notify_bits);
+    }
+
+    skip_instruction();
+    return true;
+}
+
+bool Vcpu::is_single_stepping()
+{
+    return (vmcs_cache.read(Vmcs_cache::RFLAGS) & Cpu::EFL_TF) or (utcb()->ctrl[0] & Vmcs::Ctrl0::CPU_MTF);
+}
+
+void Vcpu::skip_instruction()
+{
+    mword rip{vmcs_cache.read(Vmcs_cache::RIP) + Vmcs::read(Vmcs::EXI_INST_LEN)};
+
+    // The instruction pointer wraps according to the size of the code segment. See the L (bit 13) and D/B
+    // (bit 14) bits of the segment access rights in Intel SDM Vol. 3 Chap. 25.4.1.
+    const mword cs_ar{vmcs_cache.read(Vmcs_cache::AR_CS)};
+
+    if (not(cs_ar & (1U << 13))) {
+        rip &= (cs_ar & (1U << 14)) ? 0xffffffffUL : 0xffffUL;
+    }
+
+    vmcs_cache.write(Vmcs_cache::RIP, rip);
+
+    // Completing an instruction ends blocking by STI and by MOV SS.
+    const mword intr_state{vmcs_cache.read(Vmcs_cache::INTR_STATE)};
+
+    if (intr_state & 0x3) {
+        vmcs_cache.write(Vmcs_cache::INTR_STATE, intr_state & ~0x3UL);
+    }
+}
+
 void Vcpu::maybe_handle_invalid_guest_state()
 {
     if (Vmcs::read(Vmcs::HOST_SEL_CS) != 0) {
@@ -544,37 +759,46 @@ void Vcpu::maybe_handle_invalid_guest_state()
     continue_running();
 }
 
+void Vcpu::transfer_state(Mtd mtd)
+{
+    // We never transfer
+    // - the EOI_EXIT_BITMAP and the TPR_THRESHOLD, because the hardware does not modify it
+    // - Mtd::TLB, because Utcb::load_vmx does not use it
+    // - Mtd::FPU, because we already saved the FPU
+    mtd.val &= ~(Mtd::EOI | Mtd::TPR | Mtd::TLB | Mtd::FPU);
+
+    // We only transfer the Guest interrupt status (GUEST_INTR_STS) if the "virtual-interrupt delivery"
+    // field of the VM-execution control is set. This also prevents reading these fields on CPUs where
+    // they don't exist. The CPU handles reading non-existent fields gracefully, but it is a performance
+    // issue.
+    const bool vint_delivery_enabled{(utcb()->ctrl[0] & Vmcs::Ctrl0::CPU_SECONDARY) and
+                                     (utcb()->ctrl[1] & Vmcs::Ctrl1::CPU_VINT_DELIVERY)};
+
+    if (not vint_delivery_enabled) {
+        mtd.val &= ~Mtd::VINTR;
+    }
+
+    // Utcb::load_vmx uses the Mtd bits of the given regs to determine which state to transfer, thus this
+    // time we don't have to put anything into the UTCB.
+    regs.mtd = mtd.val;
+
+    utcb()->load_vmx(&regs, vmcs_cache);
+    regs.mtd = 0;
+}
+
 void Vcpu::return_to_vmm(Sys_regs::Status status)
 {
     // We only want to write out the vCPU state to the state page when we actually entered the
     // guest. Otherwise, the state in the VMCS is stale and we would clobber the state page.
     if (has_entered) {
-        // We want to transfer the whole state, except
-        // - the EOI_EXIT_BITMAP and the TPR_THRESHOLD, because the hardware does not modify it
-        // - Mtd::TLB, because Utcb::load_vmx does not use it
-        // - Mtd::FPU, because we already saved the FPU
-        Mtd mtd{~0UL & ~(Mtd::EOI | Mtd::TPR | Mtd::TLB | Mtd::FPU)};
-
-        // We only transfer the Guest interrupt status (GUEST_INTR_STS) if the "virtual-interrupt delivery"
-        // field of the VM-execution control is set. This also prevents reading these fields on CPUs where
-        // they don't exist. The CPU handles reading non-existent fields gracefully, but it is a performance
-        // issue.
-        const bool vint_delivery_enabled{(utcb()->ctrl[0] & Vmcs::Ctrl0::CPU_SECONDARY) and
-                                         (utcb()->ctrl[1] & Vmcs::Ctrl1::CPU_VINT_DELIVERY)};
-
-        if (not vint_delivery_enabled) {
-            mtd.val &= ~Mtd::VINTR;
-        }
-
-        // Utcb::load_vmx uses the Mtd bits of the given regs to determine which state to transfer, thus this
-        // time we don't have to put anything into the UTCB.
-        regs.mtd = mtd.val;
+        // The VMM decides per exit reason which state it needs.
+        const uint32 basic_exit_reason{exit_reason() & 0xffff};
+        const Mtd mtd{basic_exit_reason < NUM_VMI ? Atomic::load(exit_mtd[basic_exit_reason]) : ~0UL};
 
-        utcb()->load_vmx(&regs);
-        regs.mtd = 0;
-        regs.dst_portal = 0;
+        transfer_state(mtd);
 
         has_entered = false;
+        has_exit_state = true;
     }
 
     utcb()->exit_reason = exit_reason();
@@ -582,6 +806,10 @@ void Vcpu::return_to_vmm(Sys_regs::Status status)
     // We can unconditionally clear the poked flag here, because we are just about to return to the VMM.
     Atomic::store(poked, false);
 
+    account_tsc(&Vcpu_exit_stats::tsc_kernel);
+    count(&Vcpu_exit_stats::vmm_returns);
+    in_vmm = true;
+
     // Return to the VMM. Ec::sys_finish releases the ownership of this vCPU by calling Vcpu::release.
     Ec::sys_finish(status);
 }
@@ -599,6 +827,12 @@ void Vcpu::poke()
         return;
     }
 
+    // The statistics page can only be replaced by the owner of the vCPU. RCU keeps the old page alive until
+    // we leave the kernel.
+    if (Vcpu_exit_stats* stats{exit_stats()}) {
+        Atomic::add(stats->pokes, static_cast<uint64>(1));
+    }
+
     if (Atomic::load(owner) == nullptr) {
         // The vCPU has no owner and thus is not running. We don't have to send an IPI.
         return;
@@ -606,7 +840,8 @@ void Vcpu::poke()
 
     if (Cpu::id() != cpu_id and Ec::remote(cpu_id) == Atomic::load(owner)) {
         // The owner of this vCPU is currently executing on another CPU, i.e. the vCPU is currently
-        // executing. We send an NMI to force a VM exit.
-        Lapic::send_nmi(cpu_id);
+        // executing. We send an NMI to force a VM exit. If an NMI is already on its way, it will force the
+        // VM exit for us.
+        Lapic::kick(cpu_id, 0);
     }
 }
@@ -0,0 +1,84 @@
+/*
+ * CPUID table tests
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+// Include the class under test first to detect any missing includes early
+#include <cpuid_table.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+
+namespace
+{
+
+using Table_page = std::array<Cpuid_entry, Cpuid_table::ENTRIES>;
+
+Cpuid_entry entry(uint32 leaf, uint32 subleaf, uint32 flags, uint32 eax)
+{
+    return {leaf, subleaf, flags, 0, eax, eax + 1, eax + 2, eax + 3};
+}
+
+} // namespace
+
+TEST_CASE("CPUID table finds leaves", "[cpuid_table]")
+{
+    Table_page page{};
+    page[0] = entry(0, 0, Cpuid_entry::VALID, 0x16);
+    page[1] = entry(0x7, 0, Cpuid_entry::VALID | Cpuid_entry::SUBLEAF, 0x70);
+    page[2] = entry(0x7, 1, Cpuid_entry::VALID | Cpuid_entry::SUBLEAF, 0x71);
+
+    Cpuid_table table{page.data()};
+    Cpuid_entry result{};
+
+    // Leaves without the subleaf flag ignore ECX.
+    REQUIRE(table.lookup(0, 0x1234, result));
+    CHECK(result.eax == 0x16);
+    CHECK(result.edx == 0x19);
+
+    REQUIRE(table.lookup(0x7, 1, result));
+    CHECK(result.eax == 0x71);
+
+    CHECK_FALSE(table.lookup(0x7, 2, result));
+    CHECK_FALSE(table.lookup(0x1, 0, result));
+}
+
+TEST_CASE("CPUID table ends at the first unused entry", "[cpuid_table]")
+{
+    Table_page page{};
+    page[0] = entry(0, 0, Cpuid_entry::VALID, 0x16);
+    page[2] = entry(0x1, 0, Cpuid_entry::VALID, 0x10);
+
+    Cpuid_table table{page.data()};
+    Cpuid_entry result{};
+
+    CHECK_FALSE(table.lookup(0x1, 0, result));
+}
+
+TEST_CASE("CPUID table can be full", "[cpuid_table]")
+{
+    Table_page page{};
+    for (uint32 i{0}; i < page.size(); i++) {
+        page[i] = entry(i, 0, Cpuid_entry::VALID, i);
+    }
+
+    Cpuid_table table{page.data()};
+    Cpuid_entry result{};
+
+    REQUIRE(table.lookup(Cpuid_table::ENTRIES - 1, 0, result));
+    CHECK(result.eax == Cpuid_table::ENTRIES - 1);
+    CHECK_FALSE(table.lookup(Cpuid_table::ENTRIES, 0, result));
+}
@@ -0,0 +1,101 @@
+/*
+ * MSR table tests
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+// Include the class under test first to detect any missing includes early
+#include <msr_table.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <array>
+
+namespace
+{
+
+using Table_page = std::array<Msr_table_entry, Msr_table::ENTRIES>;
+
+constexpr uint32 PLATFORM_INFO{0xce};
+constexpr uint32 MISC_ENABLE{0x1a0};
+constexpr uint32 MTRR_DEF_TYPE{0x2ff};
+
+} // namespace
+
+TEST_CASE("MSR table emulates reads", "[msr_table]")
+{
+    Table_page page{};
+    page[0] = {PLATFORM_INFO, Msr_table_entry::VALID | Msr_table_entry::READ, 0x8080c3af2800, 0, 0};
+    page[1] = {MISC_ENABLE, Msr_table_entry::VALID | Msr_table_entry::WRITE, 0x1, ~0ull, 0};
+
+    Msr_table table{page.data()};
+    uint64 value{0};
+
+    REQUIRE(table.read(PLATFORM_INFO, value));
+    CHECK(value == 0x8080c3af2800);
+
+    // Reads of entries without the read flag go to the VMM.
+    CHECK_FALSE(table.read(MISC_ENABLE, value));
+    CHECK_FALSE(table.read(MTRR_DEF_TYPE, value));
+}
+
+TEST_CASE("MSR table stores masked writes", "[msr_table]")
+{
+    Table_page page{};
+    page[0] = {PLATFORM_INFO, Msr_table_entry::VALID | Msr_table_entry::READ, 0x1234, 0, 0};
+    page[1] = {MISC_ENABLE, Msr_table_entry::VALID | Msr_table_entry::READ | Msr_table_entry::WRITE, 0x801, 0xff,
+               0};
+
+    Msr_table table{page.data()};
+    uint64 notify{~0ull};
+
+    // Writes of entries without the write flag go to the VMM.
+    CHECK_FALSE(table.write(PLATFORM_INFO, 0, notify));
+    CHECK(page[0].value == 0x1234);
+
+    REQUIRE(table.write(MISC_ENABLE, 0xf0f0, notify));
+    CHECK(notify == 0);
+    CHECK(page[1].value == 0x8f0);
+
+    uint64 value{0};
+    REQUIRE(table.read(MISC_ENABLE, value));
+    CHECK(value == 0x8f0);
+}
+
+TEST_CASE("MSR table reports notification bits", "[msr_table]")
+{
+    Table_page page{};
+    page[0] = {MTRR_DEF_TYPE,
+               Msr_table_entry::VALID | Msr_table_entry::WRITE | Msr_table_entry::NOTIFY |
+                   (42U << Msr_table_entry::NOTIFY_BIT_SHIFT),
+               0, ~0ull, 0};
+
+    Msr_table table{page.data()};
+    uint64 notify{0};
+
+    REQUIRE(table.write(MTRR_DEF_TYPE, 0xc06, notify));
+    CHECK(notify == 1ull << 42);
+    CHECK(page[0].value == 0xc06);
+}
+
+TEST_CASE("MSR table ends at the first unused entry", "[msr_table]")
+{
+    Table_page page{};
+    page[1] = {PLATFORM_INFO, Msr_table_entry::VALID | Msr_table_entry::READ, 0x1234, 0, 0};
+
+    Msr_table table{page.data()};
+    uint64 value{0};
+
+    CHECK_FALSE(table.read(PLATFORM_INFO, value));
+}
@@ -0,0 +1,277 @@
+/*
+ * Per-CPU Page Cache Tests
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+// Include the class under test first to detect any missing includes early
+#include <page_cache.hpp>
+
+#include <catch2/catch.hpp>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+using Test_cache = Page_cache<8>;
+
+// A trivial global page allocator protected by a single lock, standing in for the buddy allocator.
+class Global_pool
+{
+    std::mutex lock_;
+    std::vector<mword> pages_;
+
+public:
+    explicit Global_pool(size_t count)
+    {
+        for (size_t i{0}; i < count; i++) {
+            pages_.push_back((i + 1) * 0x1000);
+        }
+    }
+
+    size_t size() const { return pages_.size(); }
+
+    mword alloc()
+    {
+        std::lock_guard<std::mutex> guard{lock_};
+
+        return alloc_locked();
+    }
+
+    void free(mword page)
+    {
+        std::lock_guard<std::mutex> guard{lock_};
+
+        pages_.push_back(page);
+    }
+
+    size_t refill(mword* pages, size_t n)
+    {
+        std::lock_guard<std::mutex> guard{lock_};
+
+        size_t i{0};
+        while (i < n and (pages[i] = alloc_locked()) != 0) {
+            i++;
+        }
+
+        return i;
+    }
+
+    void drain(mword const* pages, size_t n)
+    {
+        std::lock_guard<std::mutex> guard{lock_};
+
+        pages_.insert(pages_.end(), pages, pages + n);
+    }
+
+private:
+    mword alloc_locked()
+    {
+        if (pages_.empty()) {
+            return 0;
+        }
+
+        mword const page{pages_.back()};
+        pages_.pop_back();
+        return page;
+    }
+};
+
+struct Cached_allocator {
+    Global_pool& pool;
+    Test_cache cache;
+
+    mword alloc()
+    {
+        return cache.alloc([this](mword* pages, size_t n) { return pool.refill(pages, n); });
+    }
+
+    void free(mword page)
+    {
+        cache.free(page, [this](mword const* pages, size_t n) { pool.drain(pages, n); });
+    }
+};
+
+} // namespace
+
+TEST_CASE("Page cache refills in batches", "[page_cache]")
+{
+    Global_pool pool{100};
+    Cached_allocator a{pool, {}};
+
+    CHECK(a.alloc() != 0);
+    CHECK(a.cache.misses() == 1);
+    CHECK(a.cache.count() == Test_cache::BATCH - 1);
+    CHECK(pool.size() == 100 - Test_cache::BATCH);
+
+    for (size_t i{1}; i < Test_cache::BATCH; i++) {
+        CHECK(a.alloc() != 0);
+    }
+
+    CHECK(a.cache.hits() == Test_cache::BATCH - 1);
+    CHECK(a.cache.misses() == 1);
+    CHECK(a.cache.count() == 0);
+}
+
+TEST_CASE("Page cache hands out the most recently freed page", "[page_cache]")
+{
+    Global_pool pool{100};
+    Cached_allocator a{pool, {}};
+
+    mword const page{a.alloc()};
+    a.free(page);
+
+    CHECK(a.alloc() == page);
+}
+
+TEST_CASE("Page cache drains in batches", "[page_cache]")
+{
+    Global_pool pool{100};
+    Cached_allocator a{pool, {}};
+    std::vector<mword> pages;
+
+    for (size_t i{0}; i <= 8; i++) {
+        pages.push_back(a.alloc());
+    }
+
+    // Start with an empty cache.
+    a.cache.drain_all([&pool](mword const* p, size_t n) { pool.drain(p, n); });
+    CHECK(a.cache.count() == 0);
+
+    size_t const pool_size{pool.size()};
+
+    for (size_t i{0}; i < 8; i++) {
+        a.free(pages[i]);
+    }
+
+    CHECK(a.cache.count() == 8);
+    CHECK(a.cache.full());
+    CHECK(pool.size() == pool_size);
+
+    // The cache is full, so the next free gives the older half back.
+    a.free(pages[8]);
+
+    CHECK(a.cache.count() == Test_cache::BATCH + 1);
+    CHECK(pool.size() == pool_size + Test_cache::BATCH);
+
+    // The most recently freed pages stay in the cache.
+    CHECK(a.alloc() == pages[8]);
+    CHECK(a.alloc() == pages[7]);
+}
+
+TEST_CASE("Page cache reports exhaustion of the global allocator", "[page_cache]")
+{
+    Global_pool pool{1};
+    Cached_allocator a{pool, {}};
+
+    CHECK(a.alloc() != 0);
+    CHECK(a.alloc() == 0);
+}
+
+TEST_CASE("Page cache statistics report both caches", "[page_cache]")
+{
+    Global_pool pool{100};
+    Cached_allocator a{pool, {}};
+    Cached_allocator zeroed{pool, {}};
+
+    auto const no_refill{[](mword*, size_t) -> size_t { return 0; }};
+
+    a.alloc();
+    a.alloc();
+    zeroed.free(pool.alloc());
+    zeroed.cache.alloc(no_refill);
+    zeroed.cache.alloc(no_refill);
+
+    // Zeroing pages ahead of time moves them from the page cache to the pool.
+    zeroed.free(a.cache.take([&pool](mword* pages, size_t n) { return pool.refill(pages, n); }));
+    zeroed.free(a.cache.take([&pool](mword* pages, size_t n) { return pool.refill(pages, n); }));
+
+    // Allocations that don't need a zeroed page fall back to the pool.
+    zeroed.cache.take(no_refill);
+
+    Page_cache_stats const stats{page_cache_stats(a.cache, zeroed.cache)};
+
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 1);
+    CHECK(stats.prezeroed == 2);
+    CHECK(stats.zeroed_hits == 1);
+    CHECK(stats.zeroed_misses == 1);
+    CHECK(stats.zeroed_fallbacks == 1);
+    CHECK(stats.pages == Test_cache::BATCH - 4);
+    CHECK(stats.zeroed_pages == 1);
+}
+
+TEST_CASE("Page cache counts taken pages separately", "[page_cache]")
+{
+    Global_pool pool{100};
+    Cached_allocator a{pool, {}};
+
+    auto const refill{[&pool](mword* pages, size_t n) { return pool.refill(pages, n); }};
+
+    CHECK(a.cache.take(refill) != 0);
+    CHECK(a.cache.take(refill) != 0);
+    CHECK(a.alloc() != 0);
+
+    CHECK(a.cache.taken() == 2);
+    CHECK(a.cache.hits() == 1);
+    CHECK(a.cache.misses() == 0);
+
+    // Failing to take a page is not counted.
+    Global_pool empty{0};
+    Cached_allocator b{empty, {}};
+
+    CHECK(b.cache.take([&empty](mword* pages, size_t n) { return empty.refill(pages, n); }) == 0);
+    CHECK(b.cache.taken() == 0);
+    CHECK(b.cache.misses() == 0);
+}
+
+TEST_CASE("Page cache scaling", "[.][benchmark][page_cache]")
+{
+    static constexpr size_t rounds{20000};
+
+    // Every thread repeatedly allocates a few pages and frees them again, similar to what happens when page
+    // tables are built and torn down.
+    auto const run = [](unsigned threads, bool cached) {
+        Global_pool pool{threads * 64};
+        std::vector<std::future<void>> futures;
+
+        for (unsigned t{0}; t < threads; t++) {
+            futures.push_back(std::async(std::launch::async, [&pool, cached]() {
+                Cached_allocator a{pool, {}};
+                mword pages[4];
+
+                for (size_t r{0}; r < rounds; r++) {
+                    for (auto& p : pages) {
+                        p = cached ? a.alloc() : pool.alloc();
+                    }
+                    for (auto p : pages) {
+                        cached ? a.free(p) : pool.free(p);
+                    }
+                }
+            }));
+        }
+
+        for (auto& f : futures) {
+            f.get();
+        }
+    };
+
+    for (unsigned threads : {1u, 4u, std::max(1u, std::thread::hardware_concurrency())}) {
+        BENCHMARK("global lock, " + std::to_string(threads) + " threads") { run(threads, false); };
+        BENCHMARK("page cache, " + std::to_string(threads) + " threads") { run(threads, true); };
+    }
+}
@@ -222,6 +222,9 @@ class Fake_deferred_cleanup
     using pointer_vector = std::vector<pointer>;
     pointer_vector lazy_free_pages_;
 
+    // The virtual addresses of leaf entries that need to be invalidated.
+    std::vector<uint64_t> flushed_pages_;
+
     Fake_deferred_cleanup(bool tlb_flush, pointer_vector const& lazy_free)
         : tlb_flush_{tlb_flush}, lazy_free_pages_{lazy_free}
     {
@@ -231,6 +234,7 @@ public:
     // The testing interface
 
     pointer_vector get_freed_pages() const { return lazy_free_pages_; }
+    std::vector<uint64_t> get_flushed_pages() const { return flushed_pages_; }
 
     // The interface expected by Generic_page_table
 
@@ -241,11 +245,19 @@ public:
     void ignore_tlb_flush() { tlb_flush_ = false; }
     void flush_tlb_later() { tlb_flush_ = true; }
 
+    void flush_tlb_later(uint64_t vaddr)
+    {
+        tlb_flush_ = true;
+        flushed_pages_.emplace_back(vaddr);
+    }
+
     void merge(Fake_deferred_cleanup& other)
     {
         tlb_flush_ = tlb_flush_ or other.tlb_flush_;
         lazy_free_pages_.insert(lazy_free_pages_.end(), other.lazy_free_pages_.cbegin(),
                                 other.lazy_free_pages_.cend());
+        flushed_pages_.insert(flushed_pages_.end(), other.flushed_pages_.cbegin(),
+                              other.flushed_pages_.cend());
     }
 
     void free_pages_now() { lazy_free_pages_ = {}; }
@@ -656,6 +668,43 @@ TEST_CASE("Updates that changes mappings require TLB shootdowns", "[page_table]"
     }
 }
 
+TEST_CASE("TLB shootdowns record the affected pages", "[page_table]")
+{
+    Fake_memory const mem{{{0x1000, 0x00002000 | Fake_attr::all_rights},
+                           {0x2000, 0x00003000 | Fake_attr::all_rights},
+                           {0x3000, 0x00004000 | Fake_attr::all_rights},
+                           {0x3008, 0x10000000 | Fake_attr::PTE_P | Fake_attr::PTE_S},
+                           {0x4000, 0x00000000 | Fake_attr::PTE_P},
+                           {0x4008, 0x00000000 | Fake_attr::PTE_P | Fake_attr::PTE_W}}};
+
+    Fake_hpt hpt{4, 3, 0x1000, mem};
+
+    uint64_t const superpage_vaddr{1U << twomb_order};
+
+    SECTION("Unmapping a single page records its address")
+    {
+        auto const cleanup{hpt.update({PAGE_SIZE, 0, 0, PAGE_BITS})};
+
+        CHECK(cleanup.get_flushed_pages() == std::vector<uint64_t>{PAGE_SIZE});
+    }
+
+    SECTION("Unmapping a page table records all present pages below it")
+    {
+        auto const cleanup{hpt.update({0, 0, 0, twomb_order})};
+
+        CHECK(cleanup.get_flushed_pages() == std::vector<uint64_t>{0, PAGE_SIZE});
+    }
+
+    SECTION("Splitting a superpage records the superpage")
+    {
+        auto const cleanup{hpt.update({superpage_vaddr + PAGE_SIZE, 0, 0, PAGE_BITS})};
+
+        // The split itself invalidates the superpage and the unmap the small page that replaced it.
+        CHECK(cleanup.get_flushed_pages() ==
+              std::vector<uint64_t>{superpage_vaddr, superpage_vaddr + PAGE_SIZE});
+    }
+}
+
 TEST_CASE("Update that creates superpages reclaims page table structures")
 {
     Fake_memory const mem{{{0x1000, 0x00002000 | Fake_attr::all_rights},
@@ -0,0 +1,133 @@
+/*
+ * Proxy SC Budget Tests
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+// Include the class under test first to detect any missing includes early
+#include <proxy_budget.hpp>
+
+#include <rq.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct Call {
+    Call* next{nullptr};
+};
+
+} // namespace
+
+TEST_CASE("Proxy budget limits the number of proxy SCs", "[proxy_budget]")
+{
+    Proxy_budget<2> budget;
+
+    CHECK(budget.try_add());
+    CHECK(budget.try_add());
+    CHECK_FALSE(budget.try_add());
+    CHECK(budget.proxies() == 2);
+
+    // A proxy SC without work gives its slot to the next caller.
+    CHECK(budget.try_remove([] { return false; }));
+    CHECK(budget.proxies() == 1);
+    CHECK(budget.try_add());
+    CHECK_FALSE(budget.try_add());
+}
+
+TEST_CASE("Proxy budget keeps proxy SCs with pending calls", "[proxy_budget]")
+{
+    Proxy_budget<1> budget;
+
+    CHECK(budget.try_add());
+
+    // While the proxy SC checks for pending calls, its slot is free.
+    CHECK_FALSE(budget.try_remove([&budget] { return budget.proxies() == 0; }));
+    CHECK(budget.proxies() == 1);
+    CHECK_FALSE(budget.try_add());
+}
+
+// Callers on several threads queue calls in a mailbox and create proxy SCs as the budget allows. A single
+// thread plays the CPU of the handler and runs the proxy SCs. Every call must be served, even if its caller
+// did not get a proxy SC of its own.
+TEST_CASE("Proxy budget never leaves calls without a proxy SC", "[proxy_budget]")
+{
+    static constexpr unsigned MAX{2};
+    static unsigned const caller_count{std::max(2u, std::thread::hardware_concurrency() - 1)};
+    static unsigned const per_caller{20000};
+
+    Proxy_budget<MAX> budget;
+    Mpsc_queue<Call> mailbox;
+    std::vector<std::vector<Call>> calls(caller_count, std::vector<Call>(per_caller));
+
+    std::atomic<unsigned> runnable{0};
+    std::atomic<unsigned> callers_done{0};
+    unsigned served{0};
+    unsigned max_proxies{0};
+
+    std::vector<std::thread> callers;
+
+    for (unsigned i{0}; i < caller_count; i++) {
+        callers.emplace_back([&, i] {
+            for (Call& c : calls[i]) {
+                mailbox.enqueue(&c);
+
+                if (budget.try_add()) {
+                    runnable++;
+                }
+            }
+
+            callers_done++;
+        });
+    }
+
+    auto const deadline{std::chrono::steady_clock::now() + std::chrono::seconds(60)};
+
+    while (served < caller_count * per_caller and std::chrono::steady_clock::now() < deadline) {
+        if (runnable == 0) {
+            // Once all callers are done, the remaining calls must have a proxy SC.
+            if (callers_done == caller_count) {
+                CHECK(mailbox.empty());
+                break;
+            }
+
+            std::this_thread::yield();
+            continue;
+        }
+
+        runnable--;
+        max_proxies = std::max(max_proxies, budget.proxies());
+
+        do {
+            mailbox.drain([&served](Call*) { served++; });
+        } while (not budget.try_remove([&mailbox] { return not mailbox.empty(); }));
+    }
+
+    for (auto& t : callers) {
+        t.join();
+    }
+
+    CHECK(served == caller_count * per_caller);
+    CHECK(mailbox.empty());
+
+    // A caller can take the slot that a proxy SC frees while it checks for calls one last time.
+    CHECK(max_proxies <= MAX + 1);
+    CHECK(budget.proxies() == runnable);
+}
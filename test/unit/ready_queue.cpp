@@ -0,0 +1,145 @@
+/*
+ * Ready Queue Tests
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+// Include the class under test first to detect any missing includes early
+#include <ready_queue.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+namespace
+{
+
+struct Elem {
+    unsigned prio;
+    Elem* prev{nullptr};
+    Elem* next{nullptr};
+
+    explicit Elem(unsigned prio_) : prio(prio_) {}
+};
+
+constexpr unsigned PRIORITIES{128};
+
+using Test_queue = Ready_queue<Elem, PRIORITIES>;
+
+} // namespace
+
+TEST_CASE("Empty ready queue has no top element", "[ready_queue]")
+{
+    Test_queue q;
+
+    CHECK(q.empty());
+    CHECK(q.top() == nullptr);
+    CHECK(q.top_prio() == 0);
+}
+
+TEST_CASE("Ready queue selects highest priority", "[ready_queue]")
+{
+    Test_queue q;
+    Elem low{1}, mid{63}, high{64}, highest{PRIORITIES - 1};
+
+    q.enqueue(&low);
+    CHECK(q.top() == &low);
+
+    q.enqueue(&high);
+    q.enqueue(&mid);
+    CHECK(q.top_prio() == 64);
+    CHECK(q.top() == &high);
+
+    q.enqueue(&highest);
+    CHECK(q.top() == &highest);
+
+    q.dequeue(&highest);
+    CHECK(q.top() == &high);
+
+    q.dequeue(&high);
+    CHECK(q.top() == &mid);
+
+    q.dequeue(&mid);
+    q.dequeue(&low);
+    CHECK(q.empty());
+    CHECK(q.top() == nullptr);
+}
+
+TEST_CASE("Ready queue is FIFO within a priority", "[ready_queue]")
+{
+    Test_queue q;
+    Elem a{5}, b{5}, c{5};
+
+    q.enqueue(&a);
+    q.enqueue(&b);
+    q.enqueue(&c);
+
+    CHECK(q.top() == &a);
+
+    SECTION("Dequeue from the front")
+    {
+        q.dequeue(&a);
+        CHECK(q.top() == &b);
+        q.dequeue(&b);
+        CHECK(q.top() == &c);
+        q.dequeue(&c);
+        CHECK(q.empty());
+    }
+
+    SECTION("Dequeue from the middle")
+    {
+        q.dequeue(&b);
+        CHECK(b.prev == nullptr);
+        CHECK(b.next == nullptr);
+
+        CHECK(q.top() == &a);
+        CHECK(a.next == &c);
+        CHECK(c.next == &a);
+        CHECK(q.top_prio() == 5);
+    }
+
+    SECTION("Re-enqueued element goes to the back")
+    {
+        q.dequeue(&a);
+        q.enqueue(&a);
+        CHECK(q.head(5) == &b);
+        CHECK(b.next == &c);
+        CHECK(c.next == &a);
+    }
+}
+
+TEST_CASE("Ready queue scheduling round trip", "[.][benchmark][ready_queue]")
+{
+    // Mimic the scheduler: a few sparse priorities with one running element that is put back into the queue
+    // before the next one is picked.
+    std::vector<Elem> elems;
+    for (unsigned prio : {1u, 2u, 17u, 100u}) {
+        for (unsigned i{0}; i < 4; i++) {
+            elems.emplace_back(prio);
+        }
+    }
+
+    Test_queue q;
+    for (auto& e : elems) {
+        q.enqueue(&e);
+    }
+
+    BENCHMARK("enqueue current and pick next")
+    {
+        Elem* next{q.top()};
+        q.dequeue(next);
+        q.enqueue(next);
+        return next;
+    };
+}
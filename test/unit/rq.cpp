@@ -0,0 +1,128 @@
+/*
+ * Remote Run Queue Tests
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+// Include the class under test first to detect any missing includes early
+#include <rq.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct Elem {
+    unsigned producer{0};
+    unsigned seq{0};
+    Elem* next{nullptr};
+};
+
+} // namespace
+
+TEST_CASE("MPSC queue preserves FIFO order", "[rq]")
+{
+    Mpsc_queue<Elem> q;
+    std::vector<Elem> elems(4);
+
+    CHECK(q.empty());
+
+    CHECK(q.enqueue(&elems[0]));
+    CHECK_FALSE(q.enqueue(&elems[1]));
+    CHECK_FALSE(q.enqueue(&elems[2]));
+    CHECK_FALSE(q.empty());
+
+    std::vector<Elem*> drained;
+    q.drain([&drained](Elem* e) {
+        CHECK(e->next == nullptr);
+        drained.push_back(e);
+    });
+
+    CHECK(drained == std::vector<Elem*>{&elems[0], &elems[1], &elems[2]});
+    CHECK(q.empty());
+
+    // The next enqueue is again the empty-to-nonempty edge.
+    CHECK(q.enqueue(&elems[3]));
+}
+
+TEST_CASE("MPSC queue stress test", "[rq]")
+{
+    static unsigned const producer_count{std::max(2u, std::thread::hardware_concurrency() - 1)};
+    static unsigned const per_producer{20000};
+
+    Mpsc_queue<Elem> q;
+    std::vector<std::vector<Elem>> elems(producer_count, std::vector<Elem>(per_producer));
+
+    // Counts how often a producer observed the empty-to-nonempty transition. This corresponds to the number
+    // of NMIs that would be sent in the kernel.
+    std::atomic<unsigned> notifications{0};
+    std::atomic<unsigned> producers_done{0};
+
+    std::vector<unsigned> last_seq(producer_count, 0);
+    unsigned received{0};
+    unsigned drains{0};
+    bool in_order{true};
+
+    auto const consume = [&]() {
+        q.drain([&](Elem* e) {
+            // Elements of a single producer must arrive in the order they were enqueued.
+            in_order = in_order and e->seq == last_seq[e->producer] + 1;
+            last_seq[e->producer] = e->seq;
+            received++;
+        });
+    };
+
+    {
+        std::vector<std::future<void>> futures;
+
+        for (unsigned p{0}; p < producer_count; p++) {
+            futures.push_back(std::async(std::launch::async, [&, p]() {
+                for (unsigned i{0}; i < per_producer; i++) {
+                    Elem& e{elems[p][i]};
+                    e.producer = p;
+                    e.seq = i + 1;
+
+                    if (q.enqueue(&e)) {
+                        notifications++;
+                    }
+                }
+                producers_done++;
+            }));
+        }
+
+        while (producers_done.load() != producer_count) {
+            consume();
+            drains++;
+        }
+
+        for (auto& f : futures) {
+            f.get();
+        }
+    }
+
+    consume();
+
+    CHECK(in_order);
+    CHECK(received == producer_count * per_producer);
+    CHECK(q.empty());
+
+    // A notification is only generated when the queue was empty, i.e. at most once per drain.
+    CHECK(notifications.load() >= 1);
+    CHECK(notifications.load() <= drains + 1);
+}
@@ -0,0 +1,296 @@
+/*
+ * Slab Allocator Tests
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+// Include the class under test first to detect any missing includes early
+#include <generic_slab.hpp>
+
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include <future>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+// A fake environment for the slab allocator. Pages come from the C++ heap and each thread pretends to be a
+// CPU.
+struct Fake_policy {
+    using lock_t = std::mutex;
+    using lock_guard_t = std::lock_guard<std::mutex>;
+
+    static constexpr unsigned NUM_CPUS{4};
+
+    static inline std::mutex pages_lock;
+    static inline std::set<void*> pages;
+    static inline std::atomic<long> allocated_pages{0};
+    static inline bool magazines{true};
+    static inline thread_local unsigned current_cpu{0};
+
+    static void* alloc_page()
+    {
+        void* const page{std::aligned_alloc(PAGE_SIZE, PAGE_SIZE)};
+
+        std::lock_guard<std::mutex> guard{pages_lock};
+        pages.insert(page);
+        allocated_pages++;
+
+        return page;
+    }
+
+    static void free_page(void* ptr)
+    {
+        std::lock_guard<std::mutex> guard{pages_lock};
+        pages.erase(ptr);
+        allocated_pages--;
+
+        std::free(ptr);
+    }
+
+    static bool use_magazines() { return magazines; }
+    static unsigned cpu_id() { return current_cpu; }
+
+    static inline std::vector<void*> magazine_mem;
+
+    static void* alloc_magazine(size_t size)
+    {
+        void* const mem{std::malloc(size)};
+
+        std::lock_guard<std::mutex> guard{pages_lock};
+        magazine_mem.push_back(mem);
+
+        return mem;
+    }
+};
+
+using Fake_slab_cache = Generic_slab_cache<Fake_policy>;
+
+constexpr size_t MAGAZINE_BATCH{Fake_slab_cache::magazine_t::BATCH};
+
+// Sets up the fake environment for a test. Slab caches never give back their last slab, so we release all
+// remaining pages when the test is done.
+class Fake_environment
+{
+public:
+    explicit Fake_environment(bool magazines)
+    {
+        Fake_policy::magazines = magazines;
+        Fake_policy::current_cpu = 0;
+    }
+
+    ~Fake_environment()
+    {
+        for (void* page : Fake_policy::pages) {
+            std::free(page);
+        }
+
+        Fake_policy::pages.clear();
+        Fake_policy::allocated_pages = 0;
+
+        for (void* mem : Fake_policy::magazine_mem) {
+            std::free(mem);
+        }
+
+        Fake_policy::magazine_mem.clear();
+    }
+};
+
+// Drain the magazines of all CPUs.
+void drain_all_magazines(Fake_slab_cache& cache)
+{
+    for (unsigned cpu{0}; cpu < Fake_policy::NUM_CPUS; cpu++) {
+        Fake_policy::current_cpu = cpu;
+        cache.drain_magazine();
+    }
+
+    Fake_policy::current_cpu = 0;
+}
+
+} // namespace
+
+TEST_CASE("Slab cache hands out distinct elements", "[slab]")
+{
+    Fake_environment env{GENERATE(false, true)};
+
+    Fake_slab_cache cache{48, 16};
+    std::set<void*> elems;
+
+    for (size_t i{0}; i < 10 * cache.elem; i++) {
+        void* const elem{cache.alloc()};
+
+        CHECK(reinterpret_cast<mword>(elem) % 16 == 0);
+        CHECK(elems.insert(elem).second);
+    }
+
+    for (void* elem : elems) {
+        cache.free(elem);
+    }
+
+    drain_all_magazines(cache);
+
+    // The slab cache keeps one empty slab around.
+    CHECK(Fake_policy::allocated_pages == 1);
+}
+
+TEST_CASE("Slab cache magazines hand out recently freed elements", "[slab]")
+{
+    Fake_environment env{true};
+
+    Fake_slab_cache cache{64, 8};
+
+    void* const elem{cache.alloc()};
+    cache.free(elem);
+
+    CHECK(cache.alloc() == elem);
+
+    cache.free(elem);
+    drain_all_magazines(cache);
+}
+
+TEST_CASE("Slab cache magazines are per CPU", "[slab]")
+{
+    Fake_environment env{true};
+
+    Fake_slab_cache cache{64, 8};
+
+    void* const elem{cache.alloc()};
+    cache.free(elem);
+
+    // Another CPU does not see elements in the magazine of the first CPU.
+    Fake_policy::current_cpu = 1;
+    void* const other{cache.alloc()};
+    CHECK(other != elem);
+
+    cache.free(other);
+    drain_all_magazines(cache);
+}
+
+TEST_CASE("Slab cache magazines are allocated on first use", "[slab]")
+{
+    Fake_environment env{true};
+
+    Fake_slab_cache cache{64, 8};
+
+    // Draining doesn't need a magazine.
+    drain_all_magazines(cache);
+    CHECK(Fake_policy::magazine_mem.empty());
+
+    cache.free(cache.alloc());
+    CHECK(Fake_policy::magazine_mem.size() == 1);
+
+    cache.free(cache.alloc());
+    CHECK(Fake_policy::magazine_mem.size() == 1);
+
+    Fake_policy::current_cpu = 1;
+    cache.free(cache.alloc());
+    CHECK(Fake_policy::magazine_mem.size() == 2);
+
+    drain_all_magazines(cache);
+}
+
+TEST_CASE("Slab cache handles frees on other CPUs", "[slab]")
+{
+    Fake_environment env{true};
+
+    Fake_slab_cache cache{128, 8};
+    std::vector<void*> elems;
+
+    for (size_t i{0}; i < 4 * cache.elem; i++) {
+        elems.push_back(cache.alloc());
+    }
+
+    // Free everything on another CPU. This overflows its magazine repeatedly and returns the elements to
+    // their slabs in batches.
+    Fake_policy::current_cpu = 2;
+    for (void* elem : elems) {
+        cache.free(elem);
+    }
+
+    // The freeing CPU now hands out the elements that were allocated on the first CPU.
+    void* const elem{cache.alloc()};
+    CHECK(elem == elems.back());
+    cache.free(elem);
+
+    drain_all_magazines(cache);
+    CHECK(Fake_policy::allocated_pages == 1);
+}
+
+TEST_CASE("Slab cache magazines refill in batches", "[slab]")
+{
+    Fake_environment env{true};
+
+    Fake_slab_cache cache{1024, 8};
+    REQUIRE(cache.elem < MAGAZINE_BATCH);
+
+    // A single allocation fills the magazine with a batch of elements, which needs several slabs.
+    void* const elem{cache.alloc()};
+    CHECK(Fake_policy::allocated_pages == (MAGAZINE_BATCH + cache.elem - 1) / cache.elem);
+
+    cache.free(elem);
+    drain_all_magazines(cache);
+    CHECK(Fake_policy::allocated_pages == 1);
+}
+
+TEST_CASE("Slab cache works from multiple CPUs concurrently", "[slab]")
+{
+    Fake_environment env{true};
+
+    Fake_slab_cache cache{96, 32};
+    std::atomic<size_t> corrupted{0};
+
+    auto const worker{[&cache, &corrupted](unsigned cpu) {
+        Fake_policy::current_cpu = cpu;
+
+        std::vector<mword*> elems;
+        for (unsigned round{0}; round < 100; round++) {
+            for (unsigned i{0}; i < 50; i++) {
+                mword* const elem{static_cast<mword*>(cache.alloc())};
+
+                // Nobody else may use this element while we own it.
+                *elem = cpu;
+                elems.push_back(elem);
+            }
+
+            for (mword* elem : elems) {
+                if (*elem != cpu) {
+                    corrupted++;
+                }
+
+                cache.free(elem);
+            }
+
+            elems.clear();
+        }
+
+        cache.drain_magazine();
+    }};
+
+    std::vector<std::future<void>> futures;
+    for (unsigned cpu{0}; cpu < Fake_policy::NUM_CPUS; cpu++) {
+        futures.push_back(std::async(std::launch::async, worker, cpu));
+    }
+
+    for (auto& f : futures) {
+        f.get();
+    }
+
+    CHECK(corrupted == 0);
+    CHECK(Fake_policy::allocated_pages == 1);
+}
@@ -0,0 +1,70 @@
+/*
+ * TLB Range Tracking Tests
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+// Include the class under test first to detect any missing includes early
+#include <tlb_ranges.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+TEST_CASE("TLB ranges collect individual pages", "[tlb_ranges]")
+{
+    Tlb_ranges ranges;
+
+    CHECK(ranges.empty());
+
+    ranges.add(0x1000);
+    ranges.add(0x5000);
+
+    CHECK_FALSE(ranges.empty());
+    CHECK_FALSE(ranges.full());
+    CHECK(std::vector<mword>(ranges.begin(), ranges.end()) == std::vector<mword>{0x1000, 0x5000});
+
+    ranges.clear();
+    CHECK(ranges.empty());
+}
+
+TEST_CASE("TLB ranges degrade to a full flush", "[tlb_ranges]")
+{
+    Tlb_ranges ranges;
+
+    SECTION("on overflow")
+    {
+        for (mword i{0}; i <= Tlb_ranges::MAX_PAGES; i++) {
+            ranges.add(i * 0x1000);
+        }
+
+        CHECK(ranges.full());
+        CHECK(ranges.count() == 0);
+    }
+
+    SECTION("when merging a full flush")
+    {
+        Tlb_ranges full;
+        full.add_full();
+
+        ranges.add(0x1000);
+        ranges.merge(full);
+
+        CHECK(ranges.full());
+
+        // Adding pages to a full flush does not change anything.
+        ranges.add(0x2000);
+        CHECK(ranges.count() == 0);
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ * VMCS field cache tests
+ *
+ * Copyright (C) 2026 Cyberus Technology GmbH.
+ *
+ * This file is part of the Hedron hypervisor.
+ *
+ * Hedron is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * Hedron is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License version 2 for more details.
+ */
+
+// Include the class under test first to detect any missing includes early
+#include <vmcs_cache.hpp>
+
+#include <catch2/catch.hpp>
+#include <map>
+
+namespace
+{
+
+// A VMCS that lives in a map and counts accesses.
+struct Fake_vmcs : public Vmcs {
+    static inline std::map<mword, mword> fields;
+    static inline int reads{0};
+    static inline int writes{0};
+
+    static void reset()
+    {
+        fields.clear();
+        reads = 0;
+        writes = 0;
+    }
+
+    static mword read(Encoding enc)
+    {
+        reads++;
+        return fields[enc];
+    }
+
+    static void write(Encoding enc, mword val)
+    {
+        writes++;
+        fields[enc] = val;
+    }
+};
+
+using Test_cache = Generic_vmcs_cache<Fake_vmcs>;
+
+} // namespace
+
+TEST_CASE("VMCS cache reads each field once", "[vmcs_cache]")
+{
+    Fake_vmcs::reset();
+    Fake_vmcs::fields[Vmcs::GUEST_RIP] = 0x1000;
+
+    Test_cache cache;
+
+    CHECK(cache.read(Test_cache::RIP) == 0x1000);
+    CHECK(cache.read(Test_cache::RIP) == 0x1000);
+    CHECK(Fake_vmcs::reads == 1);
+}
+
+TEST_CASE("VMCS cache skips writes of unchanged values", "[vmcs_cache]")
+{
+    Fake_vmcs::reset();
+    Fake_vmcs::fields[Vmcs::GUEST_RFLAGS] = 0x202;
+
+    Test_cache cache;
+
+    // Writing back the value that was read does not touch the VMCS.
+    cache.write(Test_cache::RFLAGS, cache.read(Test_cache::RFLAGS));
+    CHECK(Fake_vmcs::writes == 0);
+
+    cache.write(Test_cache::RFLAGS, 0x2);
+    CHECK(Fake_vmcs::writes == 1);
+    CHECK(Fake_vmcs::fields[Vmcs::GUEST_RFLAGS] == 0x2);
+
+    cache.write(Test_cache::RFLAGS, 0x2);
+    CHECK(Fake_vmcs::writes == 1);
+
+    // Unknown fields are always written.
+    cache.write(Test_cache::DR7, 0);
+    CHECK(Fake_vmcs::writes == 2);
+}
+
+TEST_CASE("VMCS cache forgets guest state", "[vmcs_cache]")
+{
+    Fake_vmcs::reset();
+
+    Test_cache cache;
+
+    cache.write(Test_cache::RSP, 0x8000);
+    cache.write(Test_cache::TSC_OFFSET, 42);
+
+    cache.invalidate_guest_state();
+
+    CHECK_FALSE(cache.is_valid(Test_cache::RSP));
+    CHECK(cache.is_valid(Test_cache::TSC_OFFSET));
+
+    // The guest modified its stack pointer while it was running.
+    Fake_vmcs::fields[Vmcs::GUEST_RSP] = 0x7ff0;
+
+    CHECK(cache.read(Test_cache::RSP) == 0x7ff0);
+    CHECK(cache.read(Test_cache::TSC_OFFSET) == 42);
+    CHECK(Fake_vmcs::reads == 1);
+
+    cache.invalidate();
+
+    CHECK_FALSE(cache.is_valid(Test_cache::RSP));
+    CHECK_FALSE(cache.is_valid(Test_cache::TSC_OFFSET));
+}